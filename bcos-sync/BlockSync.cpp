@@ -30,18 +30,46 @@ using namespace bcos::crypto;
 using namespace bcos::ledger;
 using namespace bcos::tool;
 
+// the compact block carries the header and the transaction hashes only
+static int32_t const c_compactBlockFlag = HEADER | TRANSACTIONS_HASH;
+
 BlockSync::BlockSync(BlockSyncConfig::Ptr _config, unsigned _idleWaitMs)
   : Worker("syncWorker", _idleWaitMs),
     m_config(_config),
     m_syncStatus(std::make_shared<SyncPeerStatus>(_config)),
-    m_downloadingQueue(std::make_shared<DownloadingQueue>(_config))
+    m_downloadingQueue(std::make_shared<DownloadingQueue>(_config)),
+    m_requestTracker(std::make_shared<BlockRequestTracker>(_config)),
+    m_blockCache(std::make_shared<EncodedBlockCache>(_config->encodedBlockCacheSize())),
+    m_headerChain(std::make_shared<HeaderChain>()),
+    m_headerRequestTracker(std::make_shared<BlockRequestTracker>(_config)),
+    m_servingScheduler(std::make_shared<ServingScheduler>(_config))
 {
     m_downloadBlockProcessor = std::make_shared<bcos::ThreadPool>("Download", 1);
     m_sendBlockProcessor = std::make_shared<bcos::ThreadPool>("SyncSend", 1);
-    m_downloadingTimer = std::make_shared<Timer>(m_config->downloadTimeout());
-    m_downloadingTimer->registerTimeoutHandler(boost::bind(&BlockSync::onDownloadTimeout, this));
+    // the deadline of each request is checked at a quarter of the request timeout
+    m_requestTimer = std::make_shared<Timer>(
+        std::max(m_config->requestTimeout() / 4, (size_t)50), "requestTimer");
+    m_requestTimer->registerTimeoutHandler([this]() {
+        m_downloadBlockProcessor->enqueue([this]() {
+            try
+            {
+                onRequestTimeout();
+            }
+            catch (std::exception const& e)
+            {
+                BLKSYNC_LOG(ERROR) << LOG_DESC("onRequestTimeout exception")
+                                   << LOG_KV("errorInfo", boost::diagnostic_information(e));
+            }
+        });
+    });
     m_downloadingQueue->registerNewBlockHandler(
         boost::bind(&BlockSync::onNewBlock, this, boost::placeholders::_1));
+    m_downloadingQueue->registerBlockCommittedHandler(
+        boost::bind(&BlockSync::onBlockCommitted, this, boost::placeholders::_1));
+    m_downloadingQueue->registerApplyFinishedHandler(
+        boost::bind(&BlockSync::asyncMaintainDownloadingQueue, this));
+    m_downloadingQueue->registerBlockChecker(boost::bind(&BlockSync::checkDownloadedBlock, this,
+        boost::placeholders::_1, boost::placeholders::_2));
 }
 
 void BlockSync::start()
@@ -73,6 +101,8 @@ void BlockSync::init()
                       << LOG_KV("genesisHash", genesisHash);
     m_config->setGenesisHash(genesisHash);
     m_config->resetConfig(fetcher->ledgerConfig());
+    m_headerChain->reset(
+        fetcher->ledgerConfig()->blockNumber(), fetcher->ledgerConfig()->hash());
     auto self = std::weak_ptr<BlockSync>(shared_from_this());
     m_config->frontService()->asyncGetNodeIDs(
         [self](Error::Ptr _error, std::shared_ptr<const crypto::NodeIDs> _nodeIDs) {
@@ -159,9 +189,9 @@ void BlockSync::stop()
     {
         m_sendBlockProcessor->stop();
     }
-    if (m_downloadingTimer)
+    if (m_requestTimer)
     {
-        m_downloadingTimer->destroy();
+        m_requestTimer->destroy();
     }
     m_running = false;
     finishWorker();
@@ -181,10 +211,11 @@ void BlockSync::printSyncInfo()
     {
         peer_str += peer->shortHex() + "/";
     }
+    auto chainTip = m_config->chainTip();
     BLKSYNC_LOG(TRACE) << "\n[Sync Info] --------------------------------------------\n"
                        << "            IsSyncing:    " << isSyncing() << "\n"
-                       << "            Block number: " << m_config->blockNumber() << "\n"
-                       << "            Block hash:   " << m_config->hash().abridged() << "\n"
+                       << "            Block number: " << chainTip->number << "\n"
+                       << "            Block hash:   " << chainTip->hash.abridged() << "\n"
                        << "            Genesis hash: " << m_config->genesisHash().abridged() << "\n"
                        << "            Peers size:   " << peers->size() << "\n"
                        << "[Peer Info] --------------------------------------------\n"
@@ -287,7 +318,6 @@ void BlockSync::maintainDownloadingBuffer()
         m_downloadingQueue->clear();
         return;
     }
-    m_downloadingQueue->clearFullQueueIfNotHas(m_config->nextBlock());
     m_downloadingQueue->flushBufferToQueue();
 }
 
@@ -335,7 +365,10 @@ void BlockSync::asyncNotifyBlockSyncMessage(Error::Ptr _error, NodeIDPtr _nodeID
     }
     try
     {
-        auto syncMsg = m_config->msgFactory()->createBlockSyncMsg(_data);
+        // copy the received data once, the blocks data of the message refer to it until the
+        // blocks are decoded by the downloading queue
+        auto receivedData = std::make_shared<bytes>(_data.begin(), _data.end());
+        auto syncMsg = m_config->msgFactory()->createBlockSyncMsg(receivedData);
         switch (syncMsg->packetType())
         {
         case BlockSyncPacketType::BlockStatusPacket:
@@ -394,8 +427,32 @@ void BlockSync::asyncNotifyNewBlock(
 void BlockSync::onNewBlock(bcos::ledger::LedgerConfig::Ptr _ledgerConfig)
 {
     m_config->resetConfig(_ledgerConfig);
+    m_blockCache->onNewBlock(_ledgerConfig->blockNumber(), _ledgerConfig->hash());
+    m_headerChain->onNewBlock(_ledgerConfig->blockNumber(), _ledgerConfig->hash());
     broadcastSyncStatus();
     m_downloadingQueue->clearExpiredQueueCache();
+    // the committed block releases the water mark, execute the next block
+    asyncMaintainDownloadingQueue();
+}
+
+void BlockSync::onBlockCommitted(Block::Ptr _block)
+{
+    if (m_blockCache->capacity() == 0)
+    {
+        return;
+    }
+    try
+    {
+        auto blockHeader = _block->blockHeader();
+        auto blockData = std::make_shared<bytes>();
+        _block->encode(*blockData);
+        m_blockCache->insert(blockHeader->number(), blockHeader->hash(), blockData);
+    }
+    catch (std::exception const& e)
+    {
+        BLKSYNC_LOG(WARNING) << LOG_DESC("onBlockCommitted: cache the block exception")
+                             << LOG_KV("error", boost::diagnostic_information(e));
+    }
 }
 
 void BlockSync::onPeerStatus(NodeIDPtr _nodeID, BlockSyncMsgInterface::Ptr _syncMsg)
@@ -416,11 +473,74 @@ void BlockSync::onPeerBlocks(NodeIDPtr _nodeID, BlockSyncMsgInterface::Ptr _sync
     auto blockMsg = m_config->msgFactory()->createBlocksMsg(_syncMsg);
     BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
                        << LOG_DESC("Receive peer block packet")
-                       << LOG_KV("peer", _nodeID->shortHex());
-    m_downloadingQueue->push(blockMsg);
+                       << LOG_KV("peer", _nodeID->shortHex())
+                       << LOG_KV("blockFlag", blockMsg->blockFlag());
+    if (blockMsg->blockFlag() == HEADER)
+    {
+        m_downloadBlockProcessor->enqueue([this, _nodeID, blockMsg]() {
+            try
+            {
+                onPeerHeaders(_nodeID, blockMsg);
+            }
+            catch (std::exception const& e)
+            {
+                BLKSYNC_LOG(WARNING) << LOG_DESC("onPeerHeaders exception")
+                                     << LOG_KV("peer", _nodeID->shortHex())
+                                     << LOG_KV("error", boost::diagnostic_information(e));
+            }
+        });
+        return;
+    }
+    if (blockMsg->blockFlag() == c_compactBlockFlag)
+    {
+        m_downloadBlockProcessor->enqueue([this, _nodeID, blockMsg]() {
+            try
+            {
+                onPeerCompactBlocks(_nodeID, blockMsg);
+            }
+            catch (std::exception const& e)
+            {
+                BLKSYNC_LOG(WARNING) << LOG_DESC("onPeerCompactBlocks exception")
+                                     << LOG_KV("peer", _nodeID->shortHex())
+                                     << LOG_KV("error", boost::diagnostic_information(e));
+            }
+        });
+        return;
+    }
+    // the numbers are no longer in-flight, those failed to be decoded will be requested again
+    auto requests = onBlocksReceived(_nodeID, blockMsg);
+    m_downloadingQueue->push(blockMsg, _nodeID);
+    // the in-flight windows have space for the next shards
+    if (!requests.empty())
+    {
+        asyncRequestBlocks();
+    }
     m_signalled.notify_all();
 }
 
+BlockRequestEntries BlockSync::onBlocksReceived(
+    NodeIDPtr _nodeID, BlocksMsgInterface::Ptr _blocksMsg)
+{
+    auto requests = m_requestTracker->onReceived(_blocksMsg->number(), _blocksMsg->blocksSize());
+    auto peerStatus = m_syncStatus->peerStatus(_nodeID);
+    for (auto const& request : requests)
+    {
+        if (!peerStatus || request.peer->data() != _nodeID->data())
+        {
+            continue;
+        }
+        size_t receivedBytes = 0;
+        for (size_t i = 0; i < _blocksMsg->blocksSize(); i++)
+        {
+            receivedBytes += _blocksMsg->blockData(i).size();
+        }
+        peerStatus->score()->onResponse(
+            utcTime() - request.sendTime, receivedBytes, _blocksMsg->blocksSize());
+        break;
+    }
+    return requests;
+}
+
 void BlockSync::onPeerBlocksRequest(NodeIDPtr _nodeID, BlockSyncMsgInterface::Ptr _syncMsg)
 {
     auto blockRequest = m_config->msgFactory()->createBlockRequest(_syncMsg);
@@ -444,7 +564,17 @@ void BlockSync::onPeerBlocksRequest(NodeIDPtr _nodeID, BlockSyncMsgInterface::Pt
     }
     if (peerStatus)
     {
-        peerStatus->downloadRequests()->push(blockRequest->number(), blockRequest->size());
+        // the headers only and the compact blocks requests are responded separately
+        auto requestQueue = peerStatus->downloadRequests();
+        if (blockRequest->blockFlag() == HEADER)
+        {
+            requestQueue = peerStatus->headerRequests();
+        }
+        else if (blockRequest->blockFlag() == c_compactBlockFlag)
+        {
+            requestQueue = peerStatus->compactRequests();
+        }
+        requestQueue->push(blockRequest->number(), blockRequest->size());
         m_signalled.notify_all();
         return;
     }
@@ -455,113 +585,544 @@ void BlockSync::onPeerBlocksRequest(NodeIDPtr _nodeID, BlockSyncMsgInterface::Pt
                          << LOG_KV("size", blockRequest->size());
 }
 
-void BlockSync::onDownloadTimeout()
+void BlockSync::onPeerHeaders(NodeIDPtr _nodeID, BlocksMsgInterface::Ptr _blocksMsg)
 {
-    // stop the timer and reset the state to idle
-    m_downloadingTimer->stop();
-    m_state = SyncState::Idle;
+    // only the requested headers are accepted to bound the memory of the header chain
+    auto requests =
+        m_headerRequestTracker->onReceived(_blocksMsg->number(), _blocksMsg->blocksSize());
+    bool requested = false;
+    for (auto const& request : requests)
+    {
+        requested = requested || (request.peer->data() == _nodeID->data());
+    }
+    if (!requested)
+    {
+        BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("onPeerHeaders")
+                           << LOG_DESC("Receive the headers not requested")
+                           << LOG_KV("from", _blocksMsg->number())
+                           << LOG_KV("size", _blocksMsg->blocksSize())
+                           << LOG_KV("peer", _nodeID->shortHex());
+        return;
+    }
+    std::vector<BlockHeader::Ptr> headers;
+    Block::Ptr tipBlock = nullptr;
+    bool valid = true;
+    try
+    {
+        for (size_t i = 0; i < _blocksMsg->blocksSize() && valid; i++)
+        {
+            // the headers are sent without compressed
+            if (_blocksMsg->blockRawSize(i) > 0)
+            {
+                valid = false;
+                break;
+            }
+            auto block =
+                m_config->blockFactory()->createBlock(_blocksMsg->blockData(i), true, false);
+            auto header = block->blockHeader();
+            valid = header && (header->number() == _blocksMsg->number() + (BlockNumber)i);
+            headers.emplace_back(header);
+            tipBlock = block;
+        }
+    }
+    catch (std::exception const& e)
+    {
+        BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("onPeerHeaders")
+                             << LOG_DESC("Decode headers exception")
+                             << LOG_KV("error", boost::diagnostic_information(e));
+        valid = false;
+    }
+    valid = valid && tipBlock;
+    // the tip should be the same as the latest block the peer announced
+    auto peerStatus = m_syncStatus->peerStatus(_nodeID);
+    if (valid && peerStatus)
+    {
+        auto peerTip = peerStatus->chainTip();
+        auto tipHeader = tipBlock->blockHeader();
+        valid = (peerTip->number != tipHeader->number() || peerTip->hash == tipHeader->hash());
+    }
+    if (!valid)
+    {
+        BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("onPeerHeaders")
+                             << LOG_DESC("Receive invalid headers")
+                             << LOG_KV("from", _blocksMsg->number())
+                             << LOG_KV("peer", _nodeID->shortHex());
+        penalizePeer(_nodeID);
+        asyncRequestBlocks();
+        return;
+    }
+    // the headers are linked by the parent hash, check the signature list of the tip by the
+    // consensus to accept the whole segment, the result is cached for the downloaded block
+    auto self = std::weak_ptr<BlockSync>(shared_from_this());
+    m_downloadingQueue->blockVerifier()->asyncCheckBlock(
+        tipBlock, [self, _nodeID, headers](Error::Ptr _error, bool _ret) {
+            auto sync = self.lock();
+            if (!sync)
+            {
+                return;
+            }
+            sync->m_downloadBlockProcessor->enqueue([sync, _nodeID, headers, _error, _ret]() {
+                try
+                {
+                    sync->onPeerHeadersChecked(_nodeID, headers, _error, _ret);
+                }
+                catch (std::exception const& e)
+                {
+                    BLKSYNC_LOG(WARNING) << LOG_DESC("onPeerHeadersChecked exception")
+                                         << LOG_KV("peer", _nodeID->shortHex())
+                                         << LOG_KV("error", boost::diagnostic_information(e));
+                }
+            });
+        });
 }
 
-void BlockSync::downloadFinish()
+void BlockSync::onPeerHeadersChecked(
+    NodeIDPtr _nodeID, std::vector<BlockHeader::Ptr> const& _headers, Error::Ptr _error, bool _ret)
 {
-    m_downloadingTimer->stop();
-    m_state = SyncState::Idle;
+    if (_error || !_ret)
+    {
+        BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("onPeerHeadersChecked")
+                             << LOG_DESC("The signature list of the headers is invalid")
+                             << LOG_KV("from", _headers.front()->number())
+                             << LOG_KV("to", _headers.back()->number())
+                             << LOG_KV("code", _error ? _error->errorCode() : 0)
+                             << LOG_KV("peer", _nodeID->shortHex());
+        // the headers failed to be checked with error are requested again
+        if (!_error)
+        {
+            penalizePeer(_nodeID);
+        }
+        asyncRequestBlocks();
+        return;
+    }
+    if (!m_headerChain->insert(_nodeID, _headers))
+    {
+        penalizePeer(_nodeID);
+    }
+    auto conflictPeers = m_headerChain->connect();
+    for (auto const& peer : conflictPeers)
+    {
+        penalizePeer(peer);
+    }
+    BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("onPeerHeadersChecked")
+                       << LOG_KV("from", _headers.front()->number())
+                       << LOG_KV("size", _headers.size())
+                       << LOG_KV("verifiedNumber", m_headerChain->number())
+                       << LOG_KV("peer", _nodeID->shortHex());
+    // request the next headers and the blocks of the verified headers
+    asyncRequestBlocks();
 }
 
-void BlockSync::tryToRequestBlocks()
+void BlockSync::onPeerCompactBlocks(NodeIDPtr _nodeID, BlocksMsgInterface::Ptr _blocksMsg)
+{
+    auto filler = std::make_shared<CompactBlockFiller>(m_config, _blocksMsg);
+    auto self = std::weak_ptr<BlockSync>(shared_from_this());
+    // Note: the numbers keep in-flight until filled, to avoid being requested repeatedly
+    filler->fill([self, _nodeID, _blocksMsg](
+                     Blocks const& _blocks, std::vector<size_t> const& _blockSizes) {
+        auto sync = self.lock();
+        if (!sync)
+        {
+            return;
+        }
+        // handle the filled blocks in the download thread
+        sync->m_downloadBlockProcessor->enqueue(
+            [sync, _nodeID, _blocksMsg, _blocks, _blockSizes]() {
+                try
+                {
+                    sync->onCompactBlocksFilled(_nodeID, _blocksMsg, _blocks, _blockSizes);
+                }
+                catch (std::exception const& e)
+                {
+                    BLKSYNC_LOG(WARNING) << LOG_DESC("onCompactBlocksFilled exception")
+                                         << LOG_KV("peer", _nodeID->shortHex())
+                                         << LOG_KV("error", boost::diagnostic_information(e));
+                }
+            });
+    });
+}
+
+void BlockSync::onCompactBlocksFilled(NodeIDPtr _nodeID, BlocksMsgInterface::Ptr _blocksMsg,
+    Blocks const& _blocks, std::vector<size_t> const& _blockSizes)
+{
+    auto requests = onBlocksReceived(_nodeID, _blocksMsg);
+    size_t filledBlocks = 0;
+    for (size_t i = 0; i < _blocks.size(); i++)
+    {
+        if (_blocks[i])
+        {
+            m_downloadingQueue->push(_blocks[i], _blockSizes[i], _nodeID);
+            filledBlocks++;
+            continue;
+        }
+        // fall back to the blocks with the transactions
+        auto number = _blocksMsg->number() + (BlockNumber)i;
+        if (number > m_compactFallbackNumber)
+        {
+            m_compactFallbackNumber = number;
+        }
+    }
+    BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("onCompactBlocksFilled")
+                       << LOG_KV("from", _blocksMsg->number())
+                       << LOG_KV("size", _blocksMsg->blocksSize())
+                       << LOG_KV("filled", filledBlocks)
+                       << LOG_KV("fallbackNumber", m_compactFallbackNumber)
+                       << LOG_KV("peer", _nodeID->shortHex());
+    if (!requests.empty() || filledBlocks < _blocks.size())
+    {
+        asyncRequestBlocks();
+    }
+    asyncMaintainDownloadingQueue();
+}
+
+bool BlockSync::checkDownloadedBlock(NodeIDPtr _peer, Block::Ptr _block)
+{
+    if (m_headerChain->matches(_block))
+    {
+        return true;
+    }
+    // the verified headers have been checked by the consensus, only the committed block
+    // conflicting with them restarts the header chain
+    BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("checkDownloadedBlock")
+                         << LOG_DESC("The block conflicts with the verified header")
+                         << LOG_KV("number", _block->blockHeader()->number())
+                         << LOG_KV("hash", _block->blockHeader()->hash().abridged())
+                         << LOG_KV("peer", _peer ? _peer->shortHex() : "unknown");
+    if (_peer)
+    {
+        penalizePeer(_peer);
+    }
+    return false;
+}
+
+void BlockSync::penalizePeer(NodeIDPtr _peer)
+{
+    auto peerStatus = m_syncStatus->peerStatus(_peer);
+    if (peerStatus)
+    {
+        peerStatus->score()->onTimeout(m_config->requestTimeout());
+    }
+}
+
+void BlockSync::onRequestTimeout()
 {
-    // wait the downloaded block commit to the ledger, and enable the next batch requests
-    if (m_config->blockNumber() < m_config->executedBlock() &&
-        m_downloadingQueue->commitQueueSize() > 0)
+    auto expiredHeaderRequests = m_headerRequestTracker->expire();
+    for (auto const& request : expiredHeaderRequests)
+    {
+        BLKSYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                          << LOG_DESC("Header request timeout, request from other peers")
+                          << LOG_KV("from", request.from) << LOG_KV("to", request.to)
+                          << LOG_KV("peer", request.peer->shortHex());
+        penalizePeer(request.peer);
+    }
+    // the backing-off peers are skipped when requesting the headers again
+    if (!expiredHeaderRequests.empty())
     {
+        asyncRequestBlocks();
+    }
+    auto expiredRequests = m_requestTracker->expire();
+    for (auto const& request : expiredRequests)
+    {
+        BLKSYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                          << LOG_DESC("Block request timeout, request from other peers")
+                          << LOG_KV("from", request.from) << LOG_KV("to", request.to)
+                          << LOG_KV("peer", request.peer->shortHex())
+                          << LOG_KV("cost", utcTime() - request.sendTime);
+        penalizePeer(request.peer);
+        if (!shouldSyncing())
+        {
+            continue;
+        }
+        // only the holes of the timed-out request should be requested again
+        auto missingRanges = m_downloadingQueue->missingBlocks(request.from, request.to);
+        missingRanges = m_requestTracker->excludeInFlight(missingRanges);
+        if (!missingRanges.empty())
+        {
+            requestBlocks(missingRanges, request.peer);
+        }
+    }
+    if (!m_requestTracker->empty() || !m_headerRequestTracker->empty())
+    {
+        m_requestTimer->restart();
         return;
     }
-    if (m_maxRequestNumber <= m_config->blockNumber() ||
-        m_maxRequestNumber <= m_config->executedBlock())
+    m_requestTimer->stop();
+}
+
+void BlockSync::downloadFinish()
+{
+    m_state = SyncState::Idle;
+}
+
+void BlockSync::tryToRequestBlocks()
+{
+    // all the requested blocks have been received and applied
+    if (m_requestTracker->empty() && m_headerRequestTracker->empty() &&
+        m_downloadingQueue->size() == 0)
     {
         downloadFinish();
     }
-    if (!shouldSyncing() || isSyncing())
+    if (!shouldSyncing())
     {
         return;
     }
     auto requestToNumber = m_config->knownHighestNumber();
     m_config->consensus()->notifyHighestSyncingNumber(requestToNumber);
-    auto topBlock = m_downloadingQueue->top();
-    // The block in BlockQueue is not nextBlock(the BlockQueue missing some block)
-    if (topBlock)
+    // the executed blocks and the executing block have been downloaded
+    auto requestFromNumber = std::max(m_config->nextBlock(), m_config->executedBlock() + 1);
+    if (m_downloadingQueue->isApplyingBlock())
     {
-        auto topBlockHeader = topBlock->blockHeader();
-        if (topBlockHeader && topBlockHeader->number() > m_config->nextBlock())
-        {
-            requestToNumber =
-                std::min(m_config->knownHighestNumber(), (topBlockHeader->number() - 1));
-        }
+        requestFromNumber++;
+    }
+    m_requestTracker->clearExpired(requestFromNumber - 1);
+    if (headerFirst())
+    {
+        requestHeaders(requestToNumber);
+        // only the blocks of the verified headers are requested
+        requestToNumber = std::min(requestToNumber, m_headerChain->number());
     }
-    auto currentNumber = m_config->blockNumber();
     // no need to request blocks
-    if (currentNumber >= requestToNumber)
+    if (requestFromNumber > requestToNumber)
+    {
+        return;
+    }
+    // only request the holes that are neither downloaded nor in-flight
+    auto missingRanges = m_downloadingQueue->missingBlocks(requestFromNumber, requestToNumber);
+    missingRanges = m_requestTracker->excludeInFlight(missingRanges);
+    if (missingRanges.empty())
     {
         return;
     }
-    requestBlocks(currentNumber, requestToNumber);
+    requestBlocks(missingRanges);
 }
 
-void BlockSync::requestBlocks(BlockNumber _from, BlockNumber _to)
+void BlockSync::requestBlocks(BlockRanges const& _missingRanges, NodeIDPtr _excludedPeer)
 {
+    if (_missingRanges.empty())
+    {
+        return;
+    }
     m_state = SyncState::Downloading;
-    m_downloadingTimer->start();
 
-    auto blockSizePerShard = m_config->maxRequestBlocks();
-    auto shardNumber = (_to - _from + blockSizePerShard - 1) / blockSizePerShard;
-    size_t shard = 0;
-    // at most request `maxShardPerPeer` shards every time
-    for (size_t loop = 0; loop < m_config->maxShardPerPeer() && shard < shardNumber; loop++)
+    // the next block to request: missingRanges[rangeIndex].first
+    size_t rangeIndex = 0;
+    auto missingRanges = _missingRanges;
+    auto meanScore = m_syncStatus->meanScore();
+    auto maxInFlightBlocks = m_config->maxInFlightBlocksPerPeer();
+    auto maxInFlightBytes = m_config->maxInFlightBytesPerPeer();
+    auto compactBlockEnabled = compactBlock();
+    // assign one shard to each peer per round until the in-flight windows of the peers are full
+    bool requested = true;
+    size_t requestedShards = 0;
+    while (requested && rangeIndex < missingRanges.size())
     {
-        bool findPeer = false;
-        m_syncStatus->foreachPeerRandom([&](PeerStatus::Ptr _p) {
+        requested = false;
+        m_syncStatus->foreachPeerByScore([&](PeerStatus::Ptr _p) {
             if (_p->number() < m_config->knownHighestNumber())
             {
                 // Only send request to nodes which are not syncing(has max number)
                 return true;
             }
-            // shard: [from, to]
-            BlockNumber from = _from + 1 + shard * blockSizePerShard;
-            BlockNumber to = std::min((BlockNumber)(from + blockSizePerShard - 1), _to);
+            if (_excludedPeer && _p->nodeId()->data() == _excludedPeer->data())
+            {
+                return true;
+            }
+            // the in-flight window of the peer is full
+            auto score = _p->score();
+            auto inFlightBlocks = m_requestTracker->inFlightBlocks(_p->nodeId());
+            if (inFlightBlocks >= maxInFlightBlocks ||
+                (maxInFlightBytes > 0 && inFlightBlocks * score->blockSize() >= maxInFlightBytes))
+            {
+                return true;
+            }
+            // the size of the shards are scaled by the relative score of the peer
+            auto relativeScore = 1.0;
+            if (meanScore > 0 && score->measured())
+            {
+                relativeScore = std::min(score->score() / meanScore, 2.0);
+            }
+            auto blockSizePerShard = std::max(
+                (BlockNumber)(m_config->maxRequestBlocks() * relativeScore + 0.5), (BlockNumber)1);
+            blockSizePerShard =
+                std::min(blockSizePerShard, (BlockNumber)(maxInFlightBlocks - inFlightBlocks));
+            auto& range = missingRanges[rangeIndex];
+            auto from = range.first;
+            auto to = std::min(from + blockSizePerShard - 1, range.second);
             if (_p->number() < to)
             {
                 return true;  // to next peer
             }
             // found a peer
-            findPeer = true;
-            auto blockRequest = m_config->msgFactory()->createBlockRequest();
-            blockRequest->setNumber(from);
-            blockRequest->setSize(to - from + 1);
-            auto encodedData = blockRequest->encode();
-            m_config->frontService()->asyncSendMessageByNodeID(
-                ModuleID::BlockSync, _p->nodeId(), ref(*encodedData), 0, nullptr);
-
-            m_maxRequestNumber = std::max(m_maxRequestNumber.load(), to);
-
-            BLKSYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("Request")
-                              << LOG_DESC("Request blocks") << LOG_KV("from", from)
-                              << LOG_KV("to", to) << LOG_KV("curNum", m_config->blockNumber())
-                              << LOG_KV("peer", _p->nodeId()->shortHex())
-                              << LOG_KV("node", m_config->nodeID()->shortHex());
-
-            ++shard;  // shard move
-            return shard < shardNumber;
+            requested = true;
+            requestedShards++;
+            auto blockFlag = 0;
+            if (compactBlockEnabled && from > m_compactFallbackNumber &&
+                _p->supports(BlockSyncCapability::CAP_COMPACT_BLOCK))
+            {
+                blockFlag = c_compactBlockFlag;
+            }
+            sendBlockRequest(_p, from, to, blockFlag);
+            // shard move
+            range.first = to + 1;
+            if (range.first > range.second)
+            {
+                rangeIndex++;
+            }
+            return rangeIndex < missingRanges.size();
         });
-        if (!findPeer)
+    }
+    if (requestedShards == 0)
+    {
+        BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                           << LOG_DESC("No available peers to request blocks")
+                           << LOG_KV("from", missingRanges[rangeIndex].first)
+                           << LOG_KV("to", missingRanges[rangeIndex].second)
+                           << LOG_KV("inFlightBlocks", m_requestTracker->inFlightBlocks());
+    }
+}
+
+bool BlockSync::compactBlock()
+{
+    if (!m_config->enableCompactBlock() ||
+        !m_config->supports(BlockSyncCapability::CAP_COMPACT_BLOCK))
+    {
+        return false;
+    }
+    // the txpool is unlikely to hold the transactions of the blocks far behind
+    return (m_config->knownHighestNumber() - m_config->blockNumber()) <=
+           m_config->maxCompactBlockDistance();
+}
+
+bool BlockSync::headerFirst()
+{
+    if (!m_config->enableHeaderFirst() ||
+        !m_config->supports(BlockSyncCapability::CAP_HEADER_FIRST))
+    {
+        return false;
+    }
+    bool supported = false;
+    m_syncStatus->foreachPeer([&](PeerStatus::Ptr _p) {
+        supported = (_p->nodeId()->data() != m_config->nodeID()->data()) &&
+                    _p->supports(BlockSyncCapability::CAP_HEADER_FIRST) &&
+                    _p->number() >= m_config->knownHighestNumber();
+        return !supported;
+    });
+    return supported;
+}
+
+void BlockSync::requestHeaders(BlockNumber _to)
+{
+    auto verifiedNumber = m_headerChain->number();
+    m_headerRequestTracker->clearExpired(verifiedNumber);
+    // bound the memory of the verified headers ahead of the ledger
+    auto requestToNumber =
+        std::min(_to, m_config->blockNumber() + (BlockNumber)m_config->maxHeaderChainSize());
+    if (verifiedNumber >= requestToNumber)
+    {
+        return;
+    }
+    auto missingRanges = m_headerRequestTracker->excludeInFlight(
+        m_headerChain->missingRanges(verifiedNumber + 1, requestToNumber));
+    if (missingRanges.empty())
+    {
+        return;
+    }
+    size_t rangeIndex = 0;
+    m_syncStatus->foreachPeerByScore([&](PeerStatus::Ptr _p) {
+        if (!_p->supports(BlockSyncCapability::CAP_HEADER_FIRST))
         {
-            BlockNumber from = _from + shard * blockSizePerShard;
-            BlockNumber to = std::min((BlockNumber)(from + blockSizePerShard - 1), _to);
-            BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("Request")
-                                 << LOG_DESC("Couldn't find any peers to request blocks")
-                                 << LOG_KV("from", from) << LOG_KV("to", to);
-            break;
+            return true;
+        }
+        // one headers request in-flight per peer
+        if (m_headerRequestTracker->inFlightBlocks(_p->nodeId()) > 0)
+        {
+            return true;
+        }
+        auto& range = missingRanges[rangeIndex];
+        auto from = range.first;
+        auto to = std::min(from + (BlockNumber)m_config->maxRequestHeaders() - 1, range.second);
+        if (_p->number() < to)
+        {
+            return true;
+        }
+        sendBlockRequest(_p, from, to, HEADER);
+        range.first = to + 1;
+        if (range.first > range.second)
+        {
+            rangeIndex++;
+        }
+        return rangeIndex < missingRanges.size();
+    });
+}
+
+void BlockSync::sendBlockRequest(
+    PeerStatus::Ptr _peer, BlockNumber _from, BlockNumber _to, int32_t _blockFlag)
+{
+    auto blockRequest = m_config->msgFactory()->createBlockRequest();
+    blockRequest->setVersion(c_blockSyncVersion);
+    blockRequest->setNumber(_from);
+    blockRequest->setSize(_to - _from + 1);
+    blockRequest->setBlockFlag(_blockFlag);
+    auto encodedData = blockRequest->encode();
+    m_config->frontService()->asyncSendMessageByNodeID(
+        ModuleID::BlockSync, _peer->nodeId(), ref(*encodedData), 0, nullptr);
+
+    auto requestTracker = (_blockFlag == HEADER) ? m_headerRequestTracker : m_requestTracker;
+    requestTracker->onRequested(_peer->nodeId(), _from, _to);
+    if (!m_requestTimer->running())
+    {
+        m_requestTimer->start();
+    }
+
+    BLKSYNC_LOG(INFO) << LOG_BADGE("Download") << LOG_BADGE("Request")
+                      << LOG_DESC("Request blocks") << LOG_KV("from", _from) << LOG_KV("to", _to)
+                      << LOG_KV("blockFlag", _blockFlag)
+                      << LOG_KV("curNum", m_config->blockNumber())
+                      << LOG_KV("peer", _peer->nodeId()->shortHex())
+                      << LOG_KV("node", m_config->nodeID()->shortHex());
+}
+
+void BlockSync::asyncRequestBlocks()
+{
+    // the requests have already been scheduled
+    if (m_requestBlocksScheduled.exchange(true))
+    {
+        return;
+    }
+    m_downloadBlockProcessor->enqueue([this]() {
+        m_requestBlocksScheduled = false;
+        try
+        {
+            tryToRequestBlocks();
         }
+        catch (std::exception const& e)
+        {
+            BLKSYNC_LOG(ERROR) << LOG_DESC("asyncRequestBlocks exception")
+                               << LOG_KV("errorInfo", boost::diagnostic_information(e));
+        }
+    });
+}
+
+void BlockSync::asyncMaintainDownloadingQueue()
+{
+    // the pipeline has already been scheduled
+    if (m_downloadingQueueScheduled.exchange(true))
+    {
+        return;
     }
+    m_downloadBlockProcessor->enqueue([this]() {
+        m_downloadingQueueScheduled = false;
+        try
+        {
+            maintainDownloadingBuffer();
+            maintainDownloadingQueue();
+        }
+        catch (std::exception const& e)
+        {
+            BLKSYNC_LOG(ERROR) << LOG_DESC("asyncMaintainDownloadingQueue exception")
+                               << LOG_KV("errorInfo", boost::diagnostic_information(e));
+        }
+    });
 }
 
 void BlockSync::maintainDownloadingQueue()
@@ -569,6 +1130,7 @@ void BlockSync::maintainDownloadingQueue()
     if (!shouldSyncing())
     {
         m_downloadingQueue->clear();
+        m_requestTracker->clear();
         downloadFinish();
         return;
     }
@@ -584,14 +1146,22 @@ void BlockSync::maintainDownloadingQueue()
     {
         return;
     }
+    // verify the signatures of the following blocks while executing
+    m_downloadingQueue->preVerifyBlocks();
+    // the next block will be executed once the executing block finished
+    if (m_downloadingQueue->isApplyingBlock())
+    {
+        return;
+    }
 
     // limit the executed blockNumber
-    if (executedBlock >= (m_config->blockNumber() + m_waterMark))
+    auto waterMark = m_downloadingQueue->executionWaterMark()->waterMark();
+    if (executedBlock >= (m_config->blockNumber() + waterMark))
     {
         BLKSYNC_LOG(WARNING)
             << LOG_DESC("too many executed blocks have not been committed, stop execute new block")
             << LOG_KV("curNumber", m_config->blockNumber())
-            << LOG_KV("executedBlock", executedBlock);
+            << LOG_KV("executedBlock", executedBlock) << LOG_KV("waterMark", waterMark);
         return;
     }
 
@@ -610,6 +1180,23 @@ void BlockSync::maintainDownloadingQueue()
         m_downloadingQueue->top()->blockHeader()->number() == (executedBlock + 1))
     {
         auto block = m_downloadingQueue->top();
+        auto verifyResult = m_downloadingQueue->blockVerifier()->result(block);
+        if (verifyResult == BlockVerifier::VerifyResult::Invalid)
+        {
+            // the uncommitted blocks may change the consensus nodes, verify it again once they
+            // have been committed
+            if (m_config->blockNumber() < executedBlock)
+            {
+                return;
+            }
+            BLKSYNC_LOG(WARNING) << LOG_BADGE("Download")
+                                 << LOG_DESC("BlockSync: drop the block failed to be verified")
+                                 << LOG_KV("number", block->blockHeader()->number())
+                                 << LOG_KV("hash", block->blockHeader()->hash().abridged());
+            // the block will be requested again
+            m_downloadingQueue->pop();
+            return;
+        }
         m_downloadingQueue->pop();
         m_state = SyncState::Downloading;
         auto blockHeader = block->blockHeader();
@@ -628,78 +1215,187 @@ void BlockSync::maintainDownloadingQueue()
 
 void BlockSync::maintainBlockRequest()
 {
-    m_syncStatus->foreachPeerRandom([&](PeerStatus::Ptr _p) {
-        auto reqQueue = _p->downloadRequests();
-        // no need to respond
-        if (reqQueue->empty())
-        {
-            return true;
-        }
-        while (!reqQueue->empty())
+    // the node syncing or consensusing the blocks serves the peers with less budget
+    auto busy = isSyncing() || (m_config->committedProposalNumber() > m_config->blockNumber());
+    m_servingScheduler->updateBudget(busy ? m_config->busyServingRatio() : 1.0);
+    m_servingScheduler->retryFailedReads(utcTime());
+    std::vector<PeerStatus::Ptr> peers;
+    m_syncStatus->foreachPeer([&](PeerStatus::Ptr _p) {
+        if (_p->hasPendingRequests())
         {
-            auto blocksReq = reqQueue->topAndPop();
-            BlockNumber numberLimit = blocksReq->fromNumber() + blocksReq->size();
-            BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download Request: response blocks")
-                               << LOG_KV("from", blocksReq->fromNumber())
-                               << LOG_KV("size", blocksReq->size()) << LOG_KV("to", numberLimit - 1)
-                               << LOG_KV("peer", _p->nodeId()->shortHex());
-            for (BlockNumber number = blocksReq->fromNumber(); number < numberLimit; number++)
-            {
-                fetchAndSendBlock(reqQueue, _p->nodeId(), number);
-            }
+            peers.emplace_back(_p);
         }
         return true;
     });
+    if (peers.empty())
+    {
+        return;
+    }
+    // round-robin, every peer is served at most maxRequestBlocks blocks a turn, and the first
+    // peer served is rotated every round
+    auto offset = (m_servingRound++) % peers.size();
+    std::rotate(peers.begin(), peers.begin() + offset, peers.end());
+    bool served = true;
+    while (served && !m_servingScheduler->exhausted())
+    {
+        served = false;
+        for (auto const& peer : peers)
+        {
+            served = serveBlockRequests(peer, m_config->maxRequestBlocks()) || served;
+        }
+    }
+}
+
+bool BlockSync::serveBlockRequests(PeerStatus::Ptr _peer, size_t _quantum)
+{
+    size_t servedBlocks = 0;
+    // the headers are small, and sent without compressed
+    servedBlocks += respondBlockRequests(_peer, _peer->headerRequests(), HEADER,
+        BlockCompressType::CompressNone, _quantum - servedBlocks);
+    // the transaction hashes are incompressible
+    servedBlocks += respondBlockRequests(_peer, _peer->compactRequests(), c_compactBlockFlag,
+        BlockCompressType::CompressNone, _quantum - servedBlocks);
+    servedBlocks += respondBlockRequests(_peer, _peer->downloadRequests(), HEADER | TRANSACTIONS,
+        responseCompressType(_peer), _quantum - servedBlocks);
+    return servedBlocks > 0;
 }
 
-void BlockSync::fetchAndSendBlock(
-    DownloadRequestQueue::Ptr _reqQueue, PublicPtr _peer, BlockNumber _number)
+size_t BlockSync::respondBlockRequests(PeerStatus::Ptr _peer,
+    DownloadRequestQueue::Ptr _reqQueue, int32_t _blockFlag, int32_t _compressType,
+    size_t _maxBlocks)
 {
-    // only fetch blockHeader and transactions
-    auto blockFlag = HEADER | TRANSACTIONS;
+    if (_maxBlocks == 0 || _reqQueue->empty())
+    {
+        return 0;
+    }
+    auto blocksReq = _reqQueue->topAndPop();
+    if (!blocksReq)
+    {
+        return 0;
+    }
+    auto servedBlocks = m_servingScheduler->acquire(
+        _peer->servingQuota(), std::min(blocksReq->size(), _maxBlocks));
+    // the remaining blocks are served in the next turns
+    if (servedBlocks < blocksReq->size())
+    {
+        _reqQueue->push(
+            blocksReq->fromNumber() + servedBlocks, blocksReq->size() - servedBlocks);
+    }
+    if (servedBlocks == 0)
+    {
+        return 0;
+    }
+    BlockNumber numberLimit = blocksReq->fromNumber() + servedBlocks;
+    BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download Request: response blocks")
+                       << LOG_KV("from", blocksReq->fromNumber())
+                       << LOG_KV("size", servedBlocks) << LOG_KV("to", numberLimit - 1)
+                       << LOG_KV("requested", blocksReq->size())
+                       << LOG_KV("blockFlag", _blockFlag)
+                       << LOG_KV("peer", _peer->nodeId()->shortHex());
+    fetchAndSendBlocks(_reqQueue, _peer->nodeId(), blocksReq->fromNumber(), servedBlocks,
+        _blockFlag, _compressType);
+    return servedBlocks;
+}
+
+int32_t BlockSync::responseCompressType(PeerStatus::Ptr _peer)
+{
+    // only compress the blocks when both sides support it
+    auto capability = BlockSyncCapability::CAP_COMPRESS_ZSTD;
+    if (m_config->supports(capability) && _peer->supports(capability))
+    {
+        return BlockCompressType::CompressZstd;
+    }
+    return BlockCompressType::CompressNone;
+}
+
+void BlockSync::fetchAndSendBlocks(DownloadRequestQueue::Ptr _reqQueue, PublicPtr _peer,
+    BlockNumber _from, size_t _size, int32_t _blockFlag, int32_t _compressType)
+{
+    auto response = std::make_shared<BlocksResponse>(m_config, _peer, _from, _size, _compressType);
+    response->setBlockFlag(_blockFlag);
+    auto servingScheduler = m_servingScheduler;
+    // the failed block will be fetched again after backoff
+    response->registerFetchFailedHandler([servingScheduler, _reqQueue](BlockNumber _number) {
+        servingScheduler->onReadFailed(_reqQueue, _number);
+    });
+    // only the blocks with the header and the transactions are cached
+    auto blockCache = (_blockFlag == (HEADER | TRANSACTIONS)) ? m_blockCache : nullptr;
     auto self = std::weak_ptr<BlockSync>(shared_from_this());
-    m_config->ledger()->asyncGetBlockDataByNumber(_number, blockFlag,
-        [self, _reqQueue, _peer, _number](Error::Ptr _error, Block::Ptr _block) {
-            if (_error != nullptr)
-            {
-                BLKSYNC_LOG(WARNING)
-                    << LOG_DESC("fetchAndSendBlock failed for asyncGetBlockDataByNumber failed")
-                    << LOG_KV("number", _number) << LOG_KV("errorCode", _error->errorCode())
-                    << LOG_KV("errorMessage", _error->errorMessage());
-                _reqQueue->push(_number, 1);
-                return;
-            }
-            try
-            {
-                auto sync = self.lock();
-                if (!sync)
+    for (BlockNumber number = _from; number < _from + (BlockNumber)_size; number++)
+    {
+        // the recent blocks are served from the cache
+        auto cachedData = blockCache ? blockCache->get(number) : nullptr;
+        if (cachedData)
+        {
+            m_servingScheduler->onCacheHit();
+            m_servingScheduler->onBlockServed(cachedData->size());
+            response->onBlockFetched(number, cachedData);
+            continue;
+        }
+        m_config->ledger()->asyncGetBlockDataByNumber(number, _blockFlag,
+            [self, response, blockCache, servingScheduler, _reqQueue, number](
+                Error::Ptr _error, Block::Ptr _block) {
+                // the reads blocked by the in-flight reads are scheduled again
+                if (servingScheduler->onReadFinished())
                 {
+                    auto sync = self.lock();
+                    if (sync)
+                    {
+                        sync->asyncMaintainBlockRequest();
+                    }
+                }
+                if (_error != nullptr)
+                {
+                    BLKSYNC_LOG(WARNING)
+                        << LOG_DESC("fetchAndSendBlocks failed for asyncGetBlockDataByNumber failed")
+                        << LOG_KV("number", number) << LOG_KV("errorCode", _error->errorCode())
+                        << LOG_KV("errorMessage", _error->errorMessage());
+                    response->onBlockFetched(number, nullptr);
                     return;
                 }
-                auto blockHeader = _block->blockHeader();
-                auto signature = blockHeader->signatureList();
-                auto config = sync->m_config;
-                auto blocksReq = config->msgFactory()->createBlocksMsg();
-                bytesPointer blockData = std::make_shared<bytes>();
-                _block->encode(*blockData);
-                blocksReq->appendBlockData(std::move(*blockData));
-                blocksReq->setNumber(_number);
-                config->frontService()->asyncSendMessageByNodeID(
-                    ModuleID::BlockSync, _peer, ref(*(blocksReq->encode())), 0, nullptr);
-                BLKSYNC_LOG(DEBUG)
-                    << LOG_DESC("fetchAndSendBlock: response block")
-                    << LOG_KV("toPeer", _peer->shortHex()) << LOG_KV("number", _number)
-                    << LOG_KV("hash", blockHeader->hash().abridged())
-                    << LOG_KV("signatureSize", signature.size())
-                    << LOG_KV("transactionsSize", _block->transactionsSize());
-            }
-            catch (std::exception const& e)
-            {
-                BLKSYNC_LOG(WARNING)
-                    << LOG_DESC("fetchAndSendBlock exception") << LOG_KV("number", _number)
-                    << LOG_KV("error", boost::diagnostic_information(e));
-            }
-        });
+                try
+                {
+                    // the encoded block is shared by the cache and the response
+                    auto blockData = std::make_shared<bytes>();
+                    _block->encode(*blockData);
+                    if (blockCache)
+                    {
+                        blockCache->insert(number, _block->blockHeader()->hash(), blockData);
+                    }
+                    servingScheduler->onReadSucceeded(_reqQueue, number);
+                    servingScheduler->onBlockServed(blockData->size());
+                    response->onBlockFetched(number, blockData);
+                }
+                catch (std::exception const& e)
+                {
+                    BLKSYNC_LOG(WARNING)
+                        << LOG_DESC("fetchAndSendBlocks exception") << LOG_KV("number", number)
+                        << LOG_KV("error", boost::diagnostic_information(e));
+                    response->onBlockFetched(number, nullptr);
+                }
+            });
+    }
+}
+
+void BlockSync::asyncMaintainBlockRequest()
+{
+    // the serving has already been scheduled
+    if (m_blockRequestScheduled.exchange(true))
+    {
+        return;
+    }
+    m_sendBlockProcessor->enqueue([this]() {
+        m_blockRequestScheduled = false;
+        try
+        {
+            maintainBlockRequest();
+        }
+        catch (std::exception const& e)
+        {
+            BLKSYNC_LOG(ERROR) << LOG_DESC("asyncMaintainBlockRequest exception")
+                               << LOG_KV("errorInfo", boost::diagnostic_information(e));
+        }
+    });
 }
 
 void BlockSync::maintainPeersConnection()
@@ -734,6 +1430,8 @@ void BlockSync::maintainPeersConnection()
     }
     // Add new peers
     auto groupNodeList = m_config->groupNodeList();
+    auto statusMsg = syncStatusMsg();
+    m_syncStatus->updatePeerStatus(m_config->nodeID(), statusMsg.first);
     for (auto node : groupNodeList)
     {
         // skip the node-self
@@ -746,19 +1444,14 @@ void BlockSync::maintainPeersConnection()
         {
             continue;
         }
-        // create a peer
-        auto newPeerStatus = m_config->msgFactory()->createBlockSyncStatusMsg(
-            m_config->blockNumber(), m_config->hash(), m_config->genesisHash());
-        m_syncStatus->updatePeerStatus(m_config->nodeID(), newPeerStatus);
         BLKSYNC_LOG(TRACE) << LOG_BADGE("Status") << LOG_DESC("Send current status to new peer")
-                           << LOG_KV("number", newPeerStatus->number())
-                           << LOG_KV("genesisHash", newPeerStatus->genesisHash().abridged())
-                           << LOG_KV("currentHash", newPeerStatus->hash().abridged())
+                           << LOG_KV("number", statusMsg.first->number())
+                           << LOG_KV("genesisHash", statusMsg.first->genesisHash().abridged())
+                           << LOG_KV("currentHash", statusMsg.first->hash().abridged())
                            << LOG_KV("peer", node->shortHex())
                            << LOG_KV("node", m_config->nodeID()->shortHex());
-        auto encodedData = newPeerStatus->encode();
         m_config->frontService()->asyncSendMessageByNodeID(
-            ModuleID::BlockSync, node, ref(*encodedData), 0, nullptr);
+            ModuleID::BlockSync, node, ref(*(statusMsg.second)), 0, nullptr);
     }
 }
 
@@ -766,6 +1459,7 @@ void BlockSync::broadcastSyncStatus()
 {
     // broadcast sync status for all connected nodes that belongs to the group
     auto nodeList = m_config->groupNodeList();
+    auto statusMsg = syncStatusMsg();
     for (auto node : nodeList)
     {
         // the node self
@@ -778,19 +1472,35 @@ void BlockSync::broadcastSyncStatus()
         {
             continue;
         }
-        auto statusMsg = m_config->msgFactory()->createBlockSyncStatusMsg(
-            m_config->blockNumber(), m_config->hash(), m_config->genesisHash());
-        auto encodedData = statusMsg->encode();
         BLKSYNC_LOG(TRACE) << LOG_BADGE("Status") << LOG_DESC("Send current status")
-                           << LOG_KV("number", statusMsg->number())
-                           << LOG_KV("genesisHash", statusMsg->genesisHash().abridged())
-                           << LOG_KV("currentHash", statusMsg->hash().abridged())
+                           << LOG_KV("number", statusMsg.first->number())
+                           << LOG_KV("genesisHash", statusMsg.first->genesisHash().abridged())
+                           << LOG_KV("currentHash", statusMsg.first->hash().abridged())
                            << LOG_KV("peer", node->shortHex());
         m_config->frontService()->asyncSendMessageByNodeID(
-            ModuleID::BlockSync, node, ref(*encodedData), 0, nullptr);
+            ModuleID::BlockSync, node, ref(*(statusMsg.second)), 0, nullptr);
     }
 }
 
+std::pair<BlockSyncStatusInterface::Ptr, bytesConstPtr> BlockSync::syncStatusMsg()
+{
+    // the number and the hash of the same block
+    auto chainTip = m_config->chainTip();
+    auto blockNumber = chainTip->number;
+    auto const& hash = chainTip->hash;
+    auto capabilities = m_config->capabilities();
+    Guard l(x_statusMsg);
+    if (m_statusMsg && m_statusMsg->number() == blockNumber && m_statusMsg->hash() == hash &&
+        m_statusMsg->capabilities() == capabilities)
+    {
+        return std::make_pair(m_statusMsg, m_encodedStatus);
+    }
+    m_statusMsg = m_config->msgFactory()->createBlockSyncStatusMsg(
+        blockNumber, hash, m_config->genesisHash(), c_blockSyncVersion, capabilities);
+    m_encodedStatus = m_statusMsg->encode();
+    return std::make_pair(m_statusMsg, m_encodedStatus);
+}
+
 void BlockSync::asyncGetSyncInfo(std::function<void(Error::Ptr, std::string)> _onGetSyncInfo)
 {
     Json::Value syncInfo;
@@ -798,13 +1508,43 @@ void BlockSync::asyncGetSyncInfo(std::function<void(Error::Ptr, std::string)> _o
     syncInfo["genesisHash"] = *toHexString(m_config->genesisHash());
     syncInfo["nodeID"] = *toHexString(m_config->nodeID()->data());
 
-    int64_t currentNumber = m_config->blockNumber();
-    syncInfo["blockNumber"] = currentNumber;
-    syncInfo["latestHash"] = *toHexString(m_config->hash());
-    syncInfo["knownHighestNumber"] = m_config->knownHighestNumber();
-    syncInfo["knownLatestHash"] = *toHexString(m_config->knownLatestHash());
+    auto chainTip = m_config->chainTip();
+    syncInfo["blockNumber"] = chainTip->number;
+    syncInfo["latestHash"] = *toHexString(chainTip->hash);
+    auto knownChainTip = m_config->knownChainTip();
+    syncInfo["knownHighestNumber"] = knownChainTip->number;
+    syncInfo["knownLatestHash"] = *toHexString(knownChainTip->hash);
+    syncInfo["inFlightBlocks"] = (int64_t)m_requestTracker->inFlightBlocks();
+    syncInfo["headerChainNumber"] = m_headerChain->number();
+    syncInfo["inFlightHeaders"] = (int64_t)m_headerRequestTracker->inFlightBlocks();
+    syncInfo["compactFallbackNumber"] = (int64_t)m_compactFallbackNumber;
+    syncInfo["servingLoadFactor"] = m_servingScheduler->loadFactor();
+    syncInfo["servingInFlightReads"] = (Json::UInt64)m_servingScheduler->inFlightReads();
+    syncInfo["servingReadErrors"] = (Json::UInt64)m_servingScheduler->readErrors();
+    syncInfo["servingRetryingReads"] = (Json::UInt64)m_servingScheduler->retryingReads();
+    syncInfo["servingDroppedReads"] = (Json::UInt64)m_servingScheduler->droppedReads();
+    Json::Value requestsInfo(Json::arrayValue);
+    for (auto const& request : m_requestTracker->requests())
+    {
+        Json::Value info;
+        info["nodeID"] = *toHexString(request.peer->data());
+        info["from"] = request.from;
+        info["to"] = request.to;
+        info["sendTime"] = (Json::UInt64)request.sendTime;
+        info["deadline"] = (Json::UInt64)request.deadline;
+        requestsInfo.append(info);
+    }
+    syncInfo["inFlightRequests"] = requestsInfo;
+    syncInfo["encodedBlockCacheSize"] = (Json::UInt64)m_blockCache->size();
+    syncInfo["encodedBlockCacheHits"] = (Json::UInt64)m_blockCache->hits();
+    syncInfo["encodedBlockCacheMisses"] = (Json::UInt64)m_blockCache->misses();
+    syncInfo["verifiedBlockCacheSize"] =
+        (Json::UInt64)m_downloadingQueue->blockVerifier()->size();
+    syncInfo["executionWaterMark"] =
+        (int64_t)m_downloadingQueue->executionWaterMark()->waterMark();
 
     Json::Value peersInfo(Json::arrayValue);
+    size_t pendingRequests = 0;
     m_syncStatus->foreachPeer([&](PeerStatus::Ptr _p) {
         // not print the status of the node-self
         if (_p->nodeId() == m_config->nodeID())
@@ -814,11 +1554,22 @@ void BlockSync::asyncGetSyncInfo(std::function<void(Error::Ptr, std::string)> _o
         Json::Value info;
         info["nodeID"] = *toHexString(_p->nodeId()->data());
         info["genesisHash"] = *toHexString(_p->genesisHash());
-        info["blockNumber"] = _p->number();
-        info["latestHash"] = *toHexString(_p->hash());
+        auto peerChainTip = _p->chainTip();
+        info["blockNumber"] = peerChainTip->number;
+        info["latestHash"] = *toHexString(peerChainTip->hash);
+        info["version"] = _p->version();
+        info["capabilities"] = (Json::UInt64)_p->capabilities();
+        auto score = _p->score();
+        info["latency"] = score->latency();
+        info["throughput"] = score->throughput();
+        info["failureRate"] = score->failureRate();
+        info["score"] = score->score();
+        info["pendingRequests"] = (Json::UInt64)_p->pendingRequests();
+        pendingRequests += _p->pendingRequests();
         peersInfo.append(info);
         return true;
     });
+    syncInfo["servingPendingRequests"] = (Json::UInt64)pendingRequests;
 
     syncInfo["peers"] = peersInfo;
     Json::FastWriter fastWriter;
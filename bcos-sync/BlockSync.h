@@ -20,7 +20,13 @@
  */
 #pragma once
 #include "bcos-sync/BlockSyncConfig.h"
+#include "bcos-sync/state/BlockRequestTracker.h"
+#include "bcos-sync/state/BlocksResponse.h"
+#include "bcos-sync/state/CompactBlockFiller.h"
 #include "bcos-sync/state/DownloadingQueue.h"
+#include "bcos-sync/state/EncodedBlockCache.h"
+#include "bcos-sync/state/HeaderChain.h"
+#include "bcos-sync/state/ServingScheduler.h"
 #include "bcos-sync/state/SyncPeerStatus.h"
 #include <bcos-framework/interfaces/sync/BlockSyncInterface.h>
 #include <bcos-framework/libutilities/ThreadPool.h>
@@ -83,35 +89,104 @@ protected:
     virtual void onPeerBlocks(bcos::crypto::NodeIDPtr _nodeID, BlockSyncMsgInterface::Ptr _syncMsg);
     virtual void onPeerBlocksRequest(
         bcos::crypto::NodeIDPtr _nodeID, BlockSyncMsgInterface::Ptr _syncMsg);
+    // the headers requested by the header-first sync
+    virtual void onPeerHeaders(bcos::crypto::NodeIDPtr _nodeID, BlocksMsgInterface::Ptr _blocksMsg);
+    // the signature list of the tip of the headers has been checked by the consensus
+    virtual void onPeerHeadersChecked(bcos::crypto::NodeIDPtr _nodeID,
+        std::vector<bcos::protocol::BlockHeader::Ptr> const& _headers, Error::Ptr _error,
+        bool _ret);
+    // the blocks with the transaction hashes only, the transactions are filled from the txpool
+    virtual void onPeerCompactBlocks(
+        bcos::crypto::NodeIDPtr _nodeID, BlocksMsgInterface::Ptr _blocksMsg);
 
     virtual bool shouldSyncing();
     virtual bool isSyncing();
     virtual void tryToRequestBlocks();
-    virtual void onDownloadTimeout();
+    // fill the in-flight windows of the peers from the download thread once some blocks received
+    virtual void asyncRequestBlocks();
+    // re-assign the timed-out block requests to other peers
+    virtual void onRequestTimeout();
     // block execute and submit
     virtual void maintainDownloadingQueue();
     virtual void maintainDownloadingBuffer();
+    // drive the execute/commit pipeline from the download thread as soon as a stage finished
+    virtual void asyncMaintainDownloadingQueue();
     // maintain connections
     virtual void maintainPeersConnection();
     // block requests
     virtual void maintainBlockRequest();
+    // serve the block requests from the send thread once the in-flight reads are available
+    virtual void asyncMaintainBlockRequest();
     // broadcast sync status
     virtual void broadcastSyncStatus();
 
     virtual void onNewBlock(bcos::ledger::LedgerConfig::Ptr _ledgerConfig);
+    // cache the encoded data of the block committed by the sync module
+    virtual void onBlockCommitted(bcos::protocol::Block::Ptr _block);
 
     virtual void downloadFinish();
 
 protected:
-    void requestBlocks(bcos::protocol::BlockNumber _from, bcos::protocol::BlockNumber _to);
-    void fetchAndSendBlock(DownloadRequestQueue::Ptr _reqQueue, bcos::crypto::PublicPtr _peer,
-        bcos::protocol::BlockNumber _number);
+    // request the missing blocks from the peers except _excludedPeer
+    void requestBlocks(
+        BlockRanges const& _missingRanges, bcos::crypto::NodeIDPtr _excludedPeer = nullptr);
+    // _blockFlag is the parts of the requested blocks, 0 means the header and the transactions
+    void sendBlockRequest(PeerStatus::Ptr _peer, bcos::protocol::BlockNumber _from,
+        bcos::protocol::BlockNumber _to, int32_t _blockFlag = 0);
+    // mark the blocks of _blocksMsg received and measure the peer, return the covered requests
+    BlockRequestEntries onBlocksReceived(
+        bcos::crypto::NodeIDPtr _nodeID, BlocksMsgInterface::Ptr _blocksMsg);
+    // the blocks failed to be filled are requested again with the transactions
+    void onCompactBlocksFilled(bcos::crypto::NodeIDPtr _nodeID,
+        BlocksMsgInterface::Ptr _blocksMsg, bcos::protocol::Blocks const& _blocks,
+        std::vector<size_t> const& _blockSizes);
+    // the compact block is enabled and this node is only a few blocks behind
+    bool compactBlock();
+    // the header-first sync is enabled and some peers support it
+    bool headerFirst();
+    // request the headers not verified up to _to, one request in-flight per peer
+    void requestHeaders(bcos::protocol::BlockNumber _to);
+    // drop the downloaded block conflicting with the verified header
+    bool checkDownloadedBlock(bcos::crypto::NodeIDPtr _peer, bcos::protocol::Block::Ptr _block);
+    // the peer sent the invalid headers or blocks, back off it as a failed request
+    void penalizePeer(bcos::crypto::NodeIDPtr _peer);
+    // the best compress type of the blocks supported by the peer
+    int32_t responseCompressType(PeerStatus::Ptr _peer);
+    // serve at most _quantum blocks requested by the peer, return false if nothing served
+    bool serveBlockRequests(PeerStatus::Ptr _peer, size_t _quantum);
+    // respond at most _maxBlocks blocks of the first requests of the given queue with the
+    // _blockFlag parts of the blocks, return the number of the blocks responded
+    size_t respondBlockRequests(PeerStatus::Ptr _peer, DownloadRequestQueue::Ptr _reqQueue,
+        int32_t _blockFlag, int32_t _compressType, size_t _maxBlocks);
+    // fetch the blocks [_from, _from + _size) and send them to the peer in batches
+    void fetchAndSendBlocks(DownloadRequestQueue::Ptr _reqQueue, bcos::crypto::PublicPtr _peer,
+        bcos::protocol::BlockNumber _from, size_t _size, int32_t _blockFlag,
+        int32_t _compressType);
+    // the status of this node and its encoded data, shared by all the peers, and encoded again
+    // only when the status changed
+    std::pair<BlockSyncStatusInterface::Ptr, bytesConstPtr> syncStatusMsg();
     void printSyncInfo();
 
 protected:
     BlockSyncConfig::Ptr m_config;
     SyncPeerStatus::Ptr m_syncStatus;
     DownloadingQueue::Ptr m_downloadingQueue;
+    BlockRequestTracker::Ptr m_requestTracker;
+    EncodedBlockCache::Ptr m_blockCache;
+    // for the header-first sync
+    HeaderChain::Ptr m_headerChain;
+    BlockRequestTracker::Ptr m_headerRequestTracker;
+    // the blocks not larger than it are requested with the transactions, since the txpool
+    // missed some transactions of the compact block
+    std::atomic<bcos::protocol::BlockNumber> m_compactFallbackNumber = {-1};
+    // limit the blocks served to the peers
+    ServingScheduler::Ptr m_servingScheduler;
+    // the number of the serving rounds, to rotate the first peer served
+    uint64_t m_servingRound = 0;
+
+    BlockSyncStatusInterface::Ptr m_statusMsg;
+    bytesConstPtr m_encodedStatus;
+    mutable Mutex x_statusMsg;
 
     std::function<void(std::string const& _id, int _moduleID, bcos::crypto::NodeIDPtr _dstNode,
         bytesConstRef _data)>
@@ -119,15 +194,17 @@ protected:
 
     bcos::ThreadPool::Ptr m_downloadBlockProcessor = nullptr;
     bcos::ThreadPool::Ptr m_sendBlockProcessor = nullptr;
-    std::shared_ptr<Timer> m_downloadingTimer;
+    // check the deadlines of the in-flight block requests
+    std::shared_ptr<Timer> m_requestTimer;
 
     std::atomic_bool m_running = {false};
     std::atomic<SyncState> m_state = {SyncState::Idle};
-    std::atomic<bcos::protocol::BlockNumber> m_maxRequestNumber = {0};
+    std::atomic_bool m_downloadingQueueScheduled = {false};
+    std::atomic_bool m_requestBlocksScheduled = {false};
+    std::atomic_bool m_blockRequestScheduled = {false};
 
     boost::condition_variable m_signalled;
     boost::mutex x_signalled;
-    bcos::protocol::BlockNumber m_waterMark = 10;
 };
 }  // namespace sync
 }  // namespace bcos
\ No newline at end of file
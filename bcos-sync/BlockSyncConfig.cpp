@@ -53,6 +53,10 @@ void BlockSyncConfig::resetConfig(LedgerConfig::Ptr _ledgerConfig)
         return;
     }
     resetBlockInfo(_ledgerConfig->blockNumber(), _ledgerConfig->hash());
+    if (consensusListChanged(_ledgerConfig->consensusNodeList()))
+    {
+        m_consensusListVersion++;
+    }
     setConsensusNodeList(_ledgerConfig->consensusNodeList());
     setObserverList(_ledgerConfig->observerNodeList());
     BLKSYNC_LOG(INFO) << LOG_DESC("BlockSyncConfig resetConfig") << LOG_KV("number", m_blockNumber)
@@ -60,68 +64,96 @@ void BlockSyncConfig::resetConfig(LedgerConfig::Ptr _ledgerConfig)
                       << LOG_KV("observerNodeSize", observerNodeList().size());
 }
 
+bool BlockSyncConfig::consensusListChanged(
+    bcos::consensus::ConsensusNodeList const& _consensusNodeList)
+{
+    auto const& currentNodeList = consensusNodeList();
+    if (currentNodeList.size() != _consensusNodeList.size())
+    {
+        return true;
+    }
+    for (size_t i = 0; i < currentNodeList.size(); i++)
+    {
+        if (currentNodeList[i]->nodeID()->data() != _consensusNodeList[i]->nodeID()->data() ||
+            currentNodeList[i]->weight() != _consensusNodeList[i]->weight())
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
 void BlockSyncConfig::setGenesisHash(HashType const& _hash)
 {
     m_genesisHash = _hash;
-    if (knownLatestHash() == HashType())
+    auto knownTip = knownChainTip();
+    if (knownTip->hash == HashType())
     {
-        setKnownLatestHash(m_genesisHash);
+        auto genesisTip = std::make_shared<ChainTip const>(knownTip->number, m_genesisHash);
+        std::atomic_compare_exchange_strong(&m_knownChainTip, &knownTip, genesisTip);
     }
 }
 
 void BlockSyncConfig::resetBlockInfo(BlockNumber _blockNumber, bcos::crypto::HashType const& _hash)
 {
+    // publish the hash before the number, the hash of chainTip() is never older than blockNumber()
+    std::atomic_store(&m_chainTip, std::make_shared<ChainTip const>(_blockNumber, _hash));
     m_blockNumber = _blockNumber;
-    setHash(_hash);
     m_nextBlock = m_blockNumber + 1;
-    if (m_knownHighestNumber < _blockNumber)
-    {
-        m_knownHighestNumber = _blockNumber;
-        setKnownLatestHash(_hash);
-    }
+    updateKnownChainTip(_blockNumber, _hash);
     if (_blockNumber > m_executedBlock)
     {
         m_executedBlock = _blockNumber;
     }
 }
 
-HashType const& BlockSyncConfig::hash() const
+bool BlockSyncConfig::updateKnownChainTip(BlockNumber _number, HashType const& _hash)
 {
-    ReadGuard l(x_hash);
-    return m_hash;
-}
-
-void BlockSyncConfig::setHash(HashType const& _hash)
-{
-    WriteGuard l(x_hash);
-    m_hash = _hash;
-}
-
-void BlockSyncConfig::setKnownHighestNumber(BlockNumber _highestNumber)
-{
-    m_knownHighestNumber = _highestNumber;
+    auto knownTip = knownChainTip();
+    if (_number <= knownTip->number)
+    {
+        return false;
+    }
+    auto newTip = std::make_shared<ChainTip const>(_number, _hash);
+    // knownTip is reloaded once updated by others
+    while (!std::atomic_compare_exchange_weak(&m_knownChainTip, &knownTip, newTip))
+    {
+        if (_number <= knownTip->number)
+        {
+            return false;
+        }
+    }
+    // the number is only increased
+    auto knownNumber = m_knownHighestNumber.load();
+    while (knownNumber < _number &&
+           !m_knownHighestNumber.compare_exchange_weak(knownNumber, _number))
+    {
+    }
+    return true;
 }
 
-void BlockSyncConfig::setKnownLatestHash(HashType const& _hash)
+void BlockSyncConfig::setMaxDownloadingBlockQueueSize(size_t _maxDownloadingBlockQueueSize)
 {
-    WriteGuard l(x_knownLatestHash);
-    m_knownLatestHash = _hash;
+    m_maxDownloadingBlockQueueSize = _maxDownloadingBlockQueueSize;
 }
 
-HashType const& BlockSyncConfig::knownLatestHash()
+void BlockSyncConfig::setMaxDownloadRequestQueueSize(size_t _maxDownloadRequestQueueSize)
 {
-    ReadGuard l(x_knownLatestHash);
-    return m_knownLatestHash;
+    m_maxDownloadRequestQueueSize = _maxDownloadRequestQueueSize;
 }
 
-void BlockSyncConfig::setMaxDownloadingBlockQueueSize(size_t _maxDownloadingBlockQueueSize)
+void BlockSyncConfig::setExecutionWaterMarkRange(
+    BlockNumber _minWaterMark, BlockNumber _maxWaterMark)
 {
-    m_maxDownloadingBlockQueueSize = _maxDownloadingBlockQueueSize;
+    // at least execute one block
+    m_minExecutionWaterMark = std::max(_minWaterMark, (BlockNumber)1);
+    m_maxExecutionWaterMark = std::max(_maxWaterMark, m_minExecutionWaterMark.load());
 }
 
-void BlockSyncConfig::setMaxDownloadRequestQueueSize(size_t _maxDownloadRequestQueueSize)
+void BlockSyncConfig::setBlockDecodeConcurrency(size_t _blockDecodeConcurrency)
 {
-    m_maxDownloadRequestQueueSize = _maxDownloadRequestQueueSize;
+    // at least one thread to decode the blocks
+    m_blockDecodeConcurrency = std::max(_blockDecodeConcurrency, (size_t)1);
 }
 
 void BlockSyncConfig::setExecutedBlock(BlockNumber _executedBlock)
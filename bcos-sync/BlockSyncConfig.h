@@ -20,6 +20,7 @@
  */
 #pragma once
 #include "bcos-sync/interfaces/BlockSyncMsgFactory.h"
+#include "bcos-sync/utilities/Common.h"
 #include <bcos-framework/interfaces/consensus/ConsensusInterface.h>
 #include <bcos-framework/interfaces/crypto/KeyInterface.h>
 #include <bcos-framework/interfaces/dispatcher/SchedulerInterface.h>
@@ -29,10 +30,22 @@
 #include <bcos-framework/interfaces/protocol/TransactionSubmitResultFactory.h>
 #include <bcos-framework/interfaces/txpool/TxPoolInterface.h>
 #include <bcos-framework/libsync/SyncConfig.h>
+#include <thread>
 namespace bcos
 {
 namespace sync
 {
+// the number and the hash of the latest block, published as a whole to be read consistently
+struct ChainTip
+{
+    using ConstPtr = std::shared_ptr<ChainTip const>;
+    ChainTip(bcos::protocol::BlockNumber _number, bcos::crypto::HashType const& _hash)
+      : number(_number), hash(_hash)
+    {}
+    bcos::protocol::BlockNumber const number;
+    bcos::crypto::HashType const hash;
+};
+
 class BlockSyncConfig : public SyncConfig
 {
 public:
@@ -68,34 +81,173 @@ public:
     void setGenesisHash(bcos::crypto::HashType const& _hash);
 
     bcos::protocol::BlockNumber blockNumber() const { return m_blockNumber; }
-    bcos::crypto::HashType const& hash() const;
+    bcos::crypto::HashType hash() const { return chainTip()->hash; }
+    // the number and the hash of the latest block of the ledger
+    ChainTip::ConstPtr chainTip() const { return std::atomic_load(&m_chainTip); }
 
     bcos::protocol::BlockNumber nextBlock() const { return m_nextBlock; }
     void resetBlockInfo(
         bcos::protocol::BlockNumber _blockNumber, bcos::crypto::HashType const& _hash);
 
-    void setKnownHighestNumber(bcos::protocol::BlockNumber _highestNumber);
-    bcos::protocol::BlockNumber knownHighestNumber() { return m_knownHighestNumber; }
-
-    void setKnownLatestHash(bcos::crypto::HashType const& _hash);
-
-    bcos::crypto::HashType const& knownLatestHash();
+    // update the highest block known from the peers if _number is higher, return false if not
+    bool updateKnownChainTip(
+        bcos::protocol::BlockNumber _number, bcos::crypto::HashType const& _hash);
+    // the highest block known from the peers
+    ChainTip::ConstPtr knownChainTip() const { return std::atomic_load(&m_knownChainTip); }
+    // published after knownChainTip, never decreased
+    bcos::protocol::BlockNumber knownHighestNumber() const { return m_knownHighestNumber; }
+    bcos::crypto::HashType knownLatestHash() const { return knownChainTip()->hash; }
 
     size_t maxDownloadingBlockQueueSize() const { return m_maxDownloadingBlockQueueSize; }
     void setMaxDownloadingBlockQueueSize(size_t _maxDownloadingBlockQueueSize);
 
+    // the max number of the blocks requested by a peer and waiting to be served
     void setMaxDownloadRequestQueueSize(size_t _maxDownloadRequestQueueSize);
 
     size_t maxDownloadRequestQueueSize() const { return m_maxDownloadRequestQueueSize; }
 
+    // the max size in bytes of the blocks packed into a BlocksMsg, a larger block is sent alone
+    size_t maxBlocksMsgSize() const { return m_maxBlocksMsgSize; }
+    void setMaxBlocksMsgSize(size_t _maxBlocksMsgSize) { m_maxBlocksMsgSize = _maxBlocksMsgSize; }
+
+    // the bitmap of BlockSyncCapability enabled by the node
+    uint64_t capabilities() const { return m_capabilities; }
+    void setCapabilities(uint64_t _capabilities) { m_capabilities = _capabilities; }
+    bool supports(uint64_t _capability) const { return (m_capabilities & _capability) != 0; }
+
+    // download the headers before the blocks, and match the blocks with the verified headers,
+    // only used when some peers support CAP_HEADER_FIRST
+    bool enableHeaderFirst() const { return m_enableHeaderFirst; }
+    void setEnableHeaderFirst(bool _enableHeaderFirst) { m_enableHeaderFirst = _enableHeaderFirst; }
+    // the max number of headers requested from a peer at a time
+    size_t maxRequestHeaders() const { return m_maxRequestHeaders; }
+    void setMaxRequestHeaders(size_t _maxRequestHeaders)
+    {
+        m_maxRequestHeaders = std::max(_maxRequestHeaders, (size_t)1);
+    }
+    // the max number of the verified headers ahead of the ledger
+    size_t maxHeaderChainSize() const { return m_maxHeaderChainSize; }
+    void setMaxHeaderChainSize(size_t _maxHeaderChainSize)
+    {
+        m_maxHeaderChainSize = _maxHeaderChainSize;
+    }
+
+    // request the blocks with the transaction hashes only, and fill the transactions from the
+    // txpool, only used when this node is at most maxCompactBlockDistance blocks behind
+    bool enableCompactBlock() const { return m_enableCompactBlock; }
+    void setEnableCompactBlock(bool _enableCompactBlock)
+    {
+        m_enableCompactBlock = _enableCompactBlock;
+    }
+    bcos::protocol::BlockNumber maxCompactBlockDistance() const
+    {
+        return m_maxCompactBlockDistance;
+    }
+    void setMaxCompactBlockDistance(bcos::protocol::BlockNumber _maxCompactBlockDistance)
+    {
+        m_maxCompactBlockDistance = _maxCompactBlockDistance;
+    }
+
+    // the blocks smaller than the threshold are sent without compressed, 0 means never compress
+    size_t compressThreshold() const { return m_compressThreshold; }
+    void setCompressThreshold(size_t _compressThreshold)
+    {
+        m_compressThreshold = _compressThreshold;
+    }
+
+    // the memory in bytes used to cache the encoded recent blocks for serving, 0 means disabled
+    size_t encodedBlockCacheSize() const { return m_encodedBlockCacheSize; }
+    void setEncodedBlockCacheSize(size_t _encodedBlockCacheSize)
+    {
+        m_encodedBlockCacheSize = _encodedBlockCacheSize;
+    }
+
+    // the budget of the ledger reads and the bytes per second to serve the blocks to all the
+    // peers, 0 means unlimited
+    size_t maxServingReadsPerSecond() const { return m_maxServingReadsPerSecond; }
+    void setMaxServingReadsPerSecond(size_t _maxServingReadsPerSecond)
+    {
+        m_maxServingReadsPerSecond = _maxServingReadsPerSecond;
+    }
+    size_t maxServingBytesPerSecond() const { return m_maxServingBytesPerSecond; }
+    void setMaxServingBytesPerSecond(size_t _maxServingBytesPerSecond)
+    {
+        m_maxServingBytesPerSecond = _maxServingBytesPerSecond;
+    }
+    // the max number of blocks per second served to a peer, 0 means unlimited
+    size_t maxServingReadsPerPeer() const { return m_maxServingReadsPerPeer; }
+    void setMaxServingReadsPerPeer(size_t _maxServingReadsPerPeer)
+    {
+        m_maxServingReadsPerPeer = _maxServingReadsPerPeer;
+    }
+    // the max number of the ledger reads in-flight to serve the blocks, 0 means unlimited
+    size_t maxServingInFlightReads() const { return m_maxServingInFlightReads; }
+    void setMaxServingInFlightReads(size_t _maxServingInFlightReads)
+    {
+        m_maxServingInFlightReads = _maxServingInFlightReads;
+    }
+    // the ratio of the serving budget used while the node is syncing or consensusing
+    double busyServingRatio() const { return m_busyServingRatio; }
+    void setBusyServingRatio(double _busyServingRatio)
+    {
+        m_busyServingRatio = std::min(std::max(_busyServingRatio, 0.01), 1.0);
+    }
+
     size_t downloadTimeout() const { return m_downloadTimeout; }
+    // the timeout(ms) of a block request, the blocks not received will be requested again
+    size_t requestTimeout() const { return m_requestTimeout; }
+    void setRequestTimeout(size_t _requestTimeout) { m_requestTimeout = _requestTimeout; }
 
     size_t maxRequestBlocks() const { return m_maxRequestBlocks; }
-    size_t maxShardPerPeer() const { return m_maxShardPerPeer; }
+    void setMaxRequestBlocks(size_t _maxRequestBlocks)
+    {
+        m_maxRequestBlocks = std::max(_maxRequestBlocks, (size_t)1);
+    }
+
+    // the max number of blocks and bytes requested from a peer but not received,
+    // the peer will be requested again once the in-flight blocks are received
+    size_t maxInFlightBlocksPerPeer() const { return m_maxInFlightBlocksPerPeer; }
+    void setMaxInFlightBlocksPerPeer(size_t _maxInFlightBlocksPerPeer)
+    {
+        m_maxInFlightBlocksPerPeer = std::max(_maxInFlightBlocksPerPeer, (size_t)1);
+    }
+    // 0 means unlimited
+    size_t maxInFlightBytesPerPeer() const { return m_maxInFlightBytesPerPeer; }
+    void setMaxInFlightBytesPerPeer(size_t _maxInFlightBytesPerPeer)
+    {
+        m_maxInFlightBytesPerPeer = _maxInFlightBytesPerPeer;
+    }
+
+    // the range of the adaptive water mark that limits the executed but uncommitted blocks
+    bcos::protocol::BlockNumber minExecutionWaterMark() const { return m_minExecutionWaterMark; }
+    bcos::protocol::BlockNumber maxExecutionWaterMark() const { return m_maxExecutionWaterMark; }
+    void setExecutionWaterMarkRange(
+        bcos::protocol::BlockNumber _minWaterMark, bcos::protocol::BlockNumber _maxWaterMark);
+    // the memory in bytes can be used by the executed but uncommitted blocks, 0 means unlimited
+    size_t executionMemoryBudget() const { return m_executionMemoryBudget; }
+    void setExecutionMemoryBudget(size_t _executionMemoryBudget)
+    {
+        m_executionMemoryBudget = _executionMemoryBudget;
+    }
+
+    // the max number of threads used to decode the downloaded blocks
+    size_t blockDecodeConcurrency() const { return m_blockDecodeConcurrency; }
+    void setBlockDecodeConcurrency(size_t _blockDecodeConcurrency);
 
     void setExecutedBlock(bcos::protocol::BlockNumber _executedBlock);
     bcos::protocol::BlockNumber executedBlock() { return m_executedBlock; }
 
+    // the max number of the downloaded blocks verified by the consensus ahead of the execution,
+    // 0 means the blocks are verified only before committed
+    size_t maxPreVerifyBlocks() const { return m_maxPreVerifyBlocks; }
+    void setMaxPreVerifyBlocks(size_t _maxPreVerifyBlocks)
+    {
+        m_maxPreVerifyBlocks = _maxPreVerifyBlocks;
+    }
+    // increased once the consensus node list changed, the blocks verified under another version
+    // should be verified again
+    uint64_t consensusListVersion() const { return m_consensusListVersion; }
+
     bcos::txpool::TxPoolInterface::Ptr txpool() { return m_txpool; }
     bcos::protocol::TransactionSubmitResultFactory::Ptr txResultFactory()
     {
@@ -113,7 +265,7 @@ public:
     }
 
 protected:
-    void setHash(bcos::crypto::HashType const& _hash);
+    bool consensusListChanged(bcos::consensus::ConsensusNodeList const& _consensusNodeList);
 
 private:
     bcos::ledger::LedgerInterface::Ptr m_ledger;
@@ -129,21 +281,43 @@ private:
     std::atomic<bcos::protocol::BlockNumber> m_blockNumber = {0};
     std::atomic<bcos::protocol::BlockNumber> m_nextBlock = {0};
     std::atomic<bcos::protocol::BlockNumber> m_executedBlock = {0};
-    bcos::crypto::HashType m_hash;
-    mutable SharedMutex x_hash;
+    // accessed by std::atomic_load and std::atomic_store
+    ChainTip::ConstPtr m_chainTip = std::make_shared<ChainTip const>(0, bcos::crypto::HashType());
 
     std::atomic<bcos::protocol::BlockNumber> m_knownHighestNumber = {0};
-    bcos::crypto::HashType m_knownLatestHash;
-    mutable SharedMutex x_knownLatestHash;
+    ChainTip::ConstPtr m_knownChainTip =
+        std::make_shared<ChainTip const>(0, bcos::crypto::HashType());
     mutable Mutex m_mutex;
 
     std::atomic<size_t> m_maxDownloadingBlockQueueSize = 256;
     std::atomic<size_t> m_maxDownloadRequestQueueSize = 1000;
+    std::atomic<size_t> m_maxBlocksMsgSize = {4 * 1024 * 1024};
+    std::atomic<uint64_t> m_capabilities = {c_blockSyncCapabilities};
+    std::atomic_bool m_enableHeaderFirst = {false};
+    std::atomic<size_t> m_maxRequestHeaders = {128};
+    std::atomic<size_t> m_maxHeaderChainSize = {8192};
+    std::atomic_bool m_enableCompactBlock = {false};
+    std::atomic<bcos::protocol::BlockNumber> m_maxCompactBlockDistance = {16};
+    std::atomic<size_t> m_compressThreshold = {4 * 1024};
+    std::atomic<size_t> m_encodedBlockCacheSize = {64 * 1024 * 1024};
+    std::atomic<size_t> m_maxServingReadsPerSecond = {1024};
+    std::atomic<size_t> m_maxServingBytesPerSecond = {64 * 1024 * 1024};
+    std::atomic<size_t> m_maxServingReadsPerPeer = {256};
+    std::atomic<size_t> m_maxServingInFlightReads = {64};
+    std::atomic<double> m_busyServingRatio = {0.25};
     std::atomic<size_t> m_downloadTimeout = (200 * m_maxDownloadingBlockQueueSize);
+    std::atomic<size_t> m_requestTimeout = {5000};
     // the max number of blocks this node can requested to
     std::atomic<size_t> m_maxRequestBlocks = {8};
 
-    std::atomic<size_t> m_maxShardPerPeer = {2};
+    std::atomic<size_t> m_maxInFlightBlocksPerPeer = {64};
+    std::atomic<size_t> m_maxInFlightBytesPerPeer = {32 * 1024 * 1024};
+    std::atomic<bcos::protocol::BlockNumber> m_minExecutionWaterMark = {2};
+    std::atomic<bcos::protocol::BlockNumber> m_maxExecutionWaterMark = {128};
+    std::atomic<size_t> m_executionMemoryBudget = {0};
+    std::atomic<size_t> m_blockDecodeConcurrency = {std::thread::hardware_concurrency()};
+    std::atomic<size_t> m_maxPreVerifyBlocks = {32};
+    std::atomic<uint64_t> m_consensusListVersion = {0};
 
     std::atomic<bcos::protocol::BlockNumber> m_committedProposalNumber = {0};
 };
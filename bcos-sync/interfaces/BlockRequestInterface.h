@@ -34,6 +34,10 @@ public:
 
     virtual size_t size() const = 0;
     virtual void setSize(size_t _size) = 0;
+
+    // the parts of the requested blocks, 0 means the header and the transactions
+    virtual int32_t blockFlag() const = 0;
+    virtual void setBlockFlag(int32_t _blockFlag) = 0;
 };
 }  // namespace sync
 }  // namespace bcos
\ No newline at end of file
@@ -34,16 +34,20 @@ public:
     virtual ~BlockSyncMsgFactory() {}
 
     virtual BlockSyncMsgInterface::Ptr createBlockSyncMsg(bytesConstRef _data) = 0;
+    // the created message refers to _data instead of copying the blocks data
+    virtual BlockSyncMsgInterface::Ptr createBlockSyncMsg(bytesConstPtr _data) = 0;
     virtual BlockSyncStatusInterface::Ptr createBlockSyncStatusMsg() = 0;
     virtual BlockSyncStatusInterface::Ptr createBlockSyncStatusMsg(bytesConstRef _data) = 0;
     virtual BlockSyncStatusInterface::Ptr createBlockSyncStatusMsg(
         BlockSyncMsgInterface::Ptr _msg) = 0;
     virtual BlockSyncStatusInterface::Ptr createBlockSyncStatusMsg(
         bcos::protocol::BlockNumber _number, bcos::crypto::HashType const& _hash,
-        bcos::crypto::HashType const& _gensisHash, int32_t _version = 0)
+        bcos::crypto::HashType const& _gensisHash, int32_t _version = 0,
+        uint64_t _capabilities = 0)
     {
         auto statusMsg = createBlockSyncStatusMsg();
         statusMsg->setVersion(_version);
+        statusMsg->setCapabilities(_capabilities);
         statusMsg->setNumber(_number);
         statusMsg->setHash(_hash);
         statusMsg->setGenesisHash(_gensisHash);
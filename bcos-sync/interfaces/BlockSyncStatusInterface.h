@@ -39,6 +39,10 @@ public:
 
     virtual void setHash(bcos::crypto::HashType const& _hash) = 0;
     virtual void setGenesisHash(bcos::crypto::HashType const& _gensisHash) = 0;
+
+    // the bitmap of BlockSyncCapability supported by the node
+    virtual uint64_t capabilities() const = 0;
+    virtual void setCapabilities(uint64_t _capabilities) = 0;
 };
 }  // namespace sync
 }  // namespace bcos
\ No newline at end of file
@@ -36,6 +36,20 @@ public:
 
     virtual void appendBlockData(bytes&& _blockData) = 0;
     virtual void appendBlockData(bytes const& _blockData) = 0;
+    // share the block data without copying
+    virtual void appendBlockData(bytesConstPtr _blockData) = 0;
+
+    // the parts of the blocks, 0 means the header and the transactions
+    virtual int32_t blockFlag() const = 0;
+    virtual void setBlockFlag(int32_t _blockFlag) = 0;
+
+    // the compress type of the compressed blocks
+    virtual int32_t compressType() const = 0;
+    virtual void setCompressType(int32_t _compressType) = 0;
+    // the size of the block before compressed, 0 means the block is not compressed
+    virtual int64_t blockRawSize(size_t _index) const = 0;
+    // append the compressed block data whose size before compressed is _rawSize
+    virtual void appendCompressedBlockData(bytesConstPtr _blockData, int64_t _rawSize) = 0;
 };
 using BlocksMsgList = std::vector<BlocksMsgInterface::Ptr>;
 using BlocksMsgListPtr = std::shared_ptr<BlocksMsgList>;
@@ -43,6 +43,9 @@ public:
     size_t size() const override { return m_syncMessage->size(); }
     void setSize(size_t _size) override { m_syncMessage->set_size(_size); }
 
+    int32_t blockFlag() const override { return m_syncMessage->blockflag(); }
+    void setBlockFlag(int32_t _blockFlag) override { m_syncMessage->set_blockflag(_blockFlag); }
+
 protected:
     explicit BlockRequestImpl(std::shared_ptr<BlockSyncMessage> _syncMessage)
     {
@@ -38,6 +38,11 @@ public:
         return std::make_shared<BlockSyncMsgImpl>(_data);
     }
 
+    BlockSyncMsgInterface::Ptr createBlockSyncMsg(bytesConstPtr _data) override
+    {
+        return std::make_shared<BlockSyncMsgImpl>(_data);
+    }
+
     BlockSyncStatusInterface::Ptr createBlockSyncStatusMsg() override
     {
         return std::make_shared<BlockSyncStatusImpl>();
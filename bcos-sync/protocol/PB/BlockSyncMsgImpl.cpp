@@ -0,0 +1,148 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief PB implement for BlockSyncMsgInterface
+ * @file BlockSyncMsgImpl.cpp
+ * @author: yujiechen
+ * @date 2021-06-20
+ */
+#include "BlockSyncMsgImpl.h"
+#include <google/protobuf/arena.h>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+
+namespace
+{
+// enough for the fields of the received message except the blocksData
+size_t const c_syncMessageArenaBlockSize = 512;
+
+enum WireType : uint64_t
+{
+    Varint = 0,
+    Fixed64 = 1,
+    LengthDelimited = 2,
+    Fixed32 = 5,
+};
+
+bool readVarint(byte const*& _pos, byte const* _end, uint64_t& _value)
+{
+    _value = 0;
+    for (unsigned shift = 0; shift < 64 && _pos < _end; shift += 7)
+    {
+        auto value = *(_pos++);
+        _value |= ((uint64_t)(value & 0x7f) << shift);
+        if ((value & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool skipBytes(byte const*& _pos, byte const* _end, uint64_t _size)
+{
+    if ((uint64_t)(_end - _pos) < _size)
+    {
+        return false;
+    }
+    _pos += _size;
+    return true;
+}
+}  // namespace
+
+void BlockSyncMsgImpl::decodeFromBuffer(bytesConstPtr _data)
+{
+    m_buffer = _data;
+    m_blockDataRefs.clear();
+    // the encoded fields except the blocksData, which are small and usually encoded ahead of the
+    // blocksData, so they are parsed from _data directly if contiguous
+    std::vector<bytesConstRef> fields;
+    auto pos = _data->data();
+    auto end = pos + _data->size();
+    while (pos < end)
+    {
+        auto fieldStart = pos;
+        uint64_t tag = 0;
+        uint64_t value = 0;
+        bool succ = readVarint(pos, end, tag);
+        switch (tag & 0x7)
+        {
+        case WireType::Varint:
+            succ = succ && readVarint(pos, end, value);
+            break;
+        case WireType::Fixed64:
+            succ = succ && skipBytes(pos, end, 8);
+            break;
+        case WireType::Fixed32:
+            succ = succ && skipBytes(pos, end, 4);
+            break;
+        case WireType::LengthDelimited:
+        {
+            succ = succ && readVarint(pos, end, value);
+            auto fieldData = pos;
+            succ = succ && skipBytes(pos, end, value);
+            if (succ && (tag >> 3) == BlockSyncMessage::kBlocksDataFieldNumber)
+            {
+                m_blockDataRefs.emplace_back(fieldData, value);
+                continue;
+            }
+            break;
+        }
+        default:
+            succ = false;
+            break;
+        }
+        if (!succ)
+        {
+            BOOST_THROW_EXCEPTION(
+                PBObjectDecodeException() << errinfo_comment("decode BlockSyncMessage failed"));
+        }
+        if (!fields.empty() && fields.back().data() + fields.back().size() == fieldStart)
+        {
+            fields.back() = bytesConstRef(fields.back().data(), pos - fields.back().data());
+            continue;
+        }
+        fields.emplace_back(fieldStart, pos - fieldStart);
+    }
+    // the fields of the message are allocated on the arena and released at once with it,
+    // the arena is kept alive by the aliasing m_syncMessage
+    google::protobuf::ArenaOptions options;
+    options.start_block_size = c_syncMessageArenaBlockSize;
+    auto arena = std::make_shared<google::protobuf::Arena>(options);
+    auto syncMessage = google::protobuf::Arena::CreateMessage<BlockSyncMessage>(arena.get());
+    m_syncMessage = std::shared_ptr<BlockSyncMessage>(arena, syncMessage);
+    bool succ = true;
+    if (fields.size() <= 1)
+    {
+        auto data = fields.empty() ? bytesConstRef() : fields.front();
+        succ = m_syncMessage->ParseFromArray(data.data(), data.size());
+    }
+    else
+    {
+        std::string fieldsData;
+        for (auto const& field : fields)
+        {
+            fieldsData.append((char const*)field.data(), field.size());
+        }
+        succ = m_syncMessage->ParseFromString(fieldsData);
+    }
+    if (!succ)
+    {
+        BOOST_THROW_EXCEPTION(
+            PBObjectDecodeException() << errinfo_comment("decode BlockSyncMessage failed"));
+    }
+}
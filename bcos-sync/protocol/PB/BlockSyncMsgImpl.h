@@ -32,14 +32,19 @@ public:
     using Ptr = std::shared_ptr<BlockSyncMsgImpl>;
     BlockSyncMsgImpl() : m_syncMessage(std::make_shared<BlockSyncMessage>()) {}
     explicit BlockSyncMsgImpl(bytesConstRef _data) : BlockSyncMsgImpl() { decode(_data); }
+    // decode without copying the blocksData, which refer to the shared _data
+    explicit BlockSyncMsgImpl(bytesConstPtr _data) { decodeFromBuffer(_data); }
 
     ~BlockSyncMsgImpl() override {}
 
     bytesPointer encode() const override { return bcos::protocol::encodePBObject(m_syncMessage); }
     void decode(bytesConstRef _data) override
     {
-        bcos::protocol::decodePBObject(m_syncMessage, _data);
+        decodeFromBuffer(std::make_shared<bytes>(_data.begin(), _data.end()));
     }
+    // the blocksData are kept as the slices of _data instead of being parsed into m_syncMessage,
+    // the other fields are parsed into a message allocated on an arena owned by m_syncMessage
+    virtual void decodeFromBuffer(bytesConstPtr _data);
 
     int32_t version() const override { return m_syncMessage->version(); }
     bcos::protocol::BlockNumber number() const override { return m_syncMessage->number(); }
@@ -55,9 +60,14 @@ public:
     void setPacketType(int32_t packetType) override { m_syncMessage->set_packettype(packetType); }
 
     std::shared_ptr<BlockSyncMessage> syncMessage() { return m_syncMessage; }
+    bytesConstPtr buffer() const { return m_buffer; }
+    std::vector<bytesConstRef> const& blockDataRefs() const { return m_blockDataRefs; }
 
 protected:
     std::shared_ptr<BlockSyncMessage> m_syncMessage;
+    // the received data decoded by decodeFromBuffer, m_blockDataRefs refer to it
+    bytesConstPtr m_buffer;
+    std::vector<bytesConstRef> m_blockDataRefs;
 };
 }  // namespace sync
 }  // namespace bcos
\ No newline at end of file
@@ -53,6 +53,12 @@ public:
     void setHash(bcos::crypto::HashType const& _hash) override;
     void setGenesisHash(bcos::crypto::HashType const& _gensisHash) override;
 
+    uint64_t capabilities() const override { return m_syncMessage->capabilities(); }
+    void setCapabilities(uint64_t _capabilities) override
+    {
+        m_syncMessage->set_capabilities(_capabilities);
+    }
+
 protected:
     virtual void deserializeObject();
 
@@ -0,0 +1,75 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief PB implementation for BlocksMsgInterface
+ * @file BlocksMsgImpl.cpp
+ * @author: yujiechen
+ * @date 2021-06-20
+ */
+#include "BlocksMsgImpl.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+
+namespace
+{
+size_t varintSize(uint64_t _value)
+{
+    size_t size = 1;
+    while (_value >= 0x80)
+    {
+        _value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+void appendVarint(bytes& _output, uint64_t _value)
+{
+    while (_value >= 0x80)
+    {
+        _output.emplace_back((byte)(_value | 0x80));
+        _value >>= 7;
+    }
+    _output.emplace_back((byte)_value);
+}
+}  // namespace
+
+bytesPointer BlocksMsgImpl::encode() const
+{
+    // m_syncMessage holds the fields except the blocksData
+    auto encodedFields = encodePBObject(m_syncMessage);
+    // tag of blocksData: (fieldNumber << 3) | lengthDelimited
+    uint64_t tag = (BlockSyncMessage::kBlocksDataFieldNumber << 3) | 2;
+    size_t encodedSize = encodedFields->size();
+    for (size_t i = 0; i < blocksSize(); i++)
+    {
+        auto blockSize = blockData(i).size();
+        encodedSize += varintSize(tag) + varintSize(blockSize) + blockSize;
+    }
+    auto encodedData = std::make_shared<bytes>();
+    encodedData->reserve(encodedSize);
+    encodedData->insert(encodedData->end(), encodedFields->begin(), encodedFields->end());
+    // the only copy of the block data when sending the message
+    for (size_t i = 0; i < blocksSize(); i++)
+    {
+        auto data = blockData(i);
+        appendVarint(*encodedData, tag);
+        appendVarint(*encodedData, data.size());
+        encodedData->insert(encodedData->end(), data.begin(), data.end());
+    }
+    return encodedData;
+}
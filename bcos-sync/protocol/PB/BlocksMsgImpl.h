@@ -36,32 +36,69 @@ public:
     }
     explicit BlocksMsgImpl(BlockSyncMsgImpl::Ptr _blockSyncMsg)
       : BlocksMsgImpl(_blockSyncMsg->syncMessage())
-    {}
+    {
+        // share the received buffer decoded without copying
+        m_buffer = _blockSyncMsg->buffer();
+        m_blockDataRefs = _blockSyncMsg->blockDataRefs();
+    }
 
     explicit BlocksMsgImpl(bytesConstRef _data) : BlocksMsgImpl() { decode(_data); }
+    explicit BlocksMsgImpl(bytesConstPtr _data) : BlocksMsgImpl() { decodeFromBuffer(_data); }
     ~BlocksMsgImpl() override {}
 
-    size_t blocksSize() const override { return m_syncMessage->blocksdata_size(); }
-    bytesConstRef blockData(size_t _index) const override
-    {
-        auto const& blockData = m_syncMessage->blocksdata(_index);
-        return bytesConstRef((byte const*)blockData.data(), blockData.size());
-    }
+    bytesPointer encode() const override;
+
+    // the blocks data are not stored in m_syncMessage, but refer to the received buffer or the
+    // appended buffers, and are written into the encoded data only once
+    size_t blocksSize() const override { return m_blockDataRefs.size(); }
+    bytesConstRef blockData(size_t _index) const override { return m_blockDataRefs[_index]; }
 
     void appendBlockData(bytes&& _blockData) override
     {
-        auto index = blocksSize();
-        auto blockSize = _blockData.size();
-        m_syncMessage->add_blocksdata();
-        m_syncMessage->set_blocksdata(index, (std::move(_blockData)).data(), blockSize);
+        appendBlockData(bytesConstPtr(std::make_shared<bytes>(std::move(_blockData))));
     }
 
     void appendBlockData(bytes const& _blockData) override
     {
-        auto index = blocksSize();
-        auto blockSize = _blockData.size();
-        m_syncMessage->add_blocksdata();
-        m_syncMessage->set_blocksdata(index, _blockData.data(), blockSize);
+        appendBlockData(bytesConstPtr(std::make_shared<bytes>(_blockData)));
+    }
+
+    void appendBlockData(bytesConstPtr _blockData) override
+    {
+        // the raw sizes are recorded only when some blocks are compressed
+        if (m_syncMessage->blocksrawsize_size() > 0)
+        {
+            m_syncMessage->add_blocksrawsize(0);
+        }
+        appendBlockBuffer(_blockData);
+    }
+
+    int32_t blockFlag() const override { return m_syncMessage->blockflag(); }
+    void setBlockFlag(int32_t _blockFlag) override { m_syncMessage->set_blockflag(_blockFlag); }
+
+    int32_t compressType() const override { return m_syncMessage->compresstype(); }
+    void setCompressType(int32_t _compressType) override
+    {
+        m_syncMessage->set_compresstype(_compressType);
+    }
+
+    int64_t blockRawSize(size_t _index) const override
+    {
+        if (_index >= (size_t)m_syncMessage->blocksrawsize_size())
+        {
+            return 0;
+        }
+        return m_syncMessage->blocksrawsize(_index);
+    }
+
+    void appendCompressedBlockData(bytesConstPtr _blockData, int64_t _rawSize) override
+    {
+        while ((size_t)m_syncMessage->blocksrawsize_size() < blocksSize())
+        {
+            m_syncMessage->add_blocksrawsize(0);
+        }
+        m_syncMessage->add_blocksrawsize(_rawSize);
+        appendBlockBuffer(_blockData);
     }
 
 protected:
@@ -70,6 +107,15 @@ protected:
         setPacketType(BlockSyncPacketType::BlockResponsePacket);
         m_syncMessage = _syncMessage;
     }
+
+private:
+    void appendBlockBuffer(bytesConstPtr _blockData)
+    {
+        m_blockDataRefs.emplace_back(_blockData->data(), _blockData->size());
+        m_blockBuffers.emplace_back(_blockData);
+    }
+
+    std::vector<bytesConstPtr> m_blockBuffers;
 };
 }  // namespace sync
 }  // namespace bcos
\ No newline at end of file
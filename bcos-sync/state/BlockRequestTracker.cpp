@@ -0,0 +1,196 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief track the requested block ranges that have not been received
+ * @file BlockRequestTracker.cpp
+ * @author: yujiechen
+ * @date 2021-06-17
+ */
+#include "BlockRequestTracker.h"
+#include "bcos-sync/utilities/Common.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+
+void BlockRequestTracker::onRequested(
+    bcos::crypto::NodeIDPtr _peer, BlockNumber _from, BlockNumber _to)
+{
+    auto sendTime = utcTime();
+    Guard l(m_mutex);
+    // the re-requested range replaces the old one
+    removeRange(_from, _to);
+    m_requests[_from] =
+        BlockRequestEntry{_peer, _from, _to, sendTime, sendTime + m_config->requestTimeout()};
+}
+
+BlockRequestEntries BlockRequestTracker::onReceived(BlockNumber _from, size_t _size)
+{
+    if (_size == 0)
+    {
+        return BlockRequestEntries();
+    }
+    Guard l(m_mutex);
+    return removeRange(_from, _from + _size - 1);
+}
+
+BlockRequestEntries BlockRequestTracker::removeRange(BlockNumber _from, BlockNumber _to)
+{
+    BlockRequestEntries removedRequests;
+    auto it = m_requests.upper_bound(_from);
+    if (it != m_requests.begin())
+    {
+        it--;
+    }
+    while (it != m_requests.end() && it->first <= _to)
+    {
+        auto requestFrom = it->first;
+        auto entry = it->second;
+        if (entry.to < _from)
+        {
+            it++;
+            continue;
+        }
+        removedRequests.emplace_back(entry);
+        it = m_requests.erase(it);
+        // keep the parts out of [_from, _to]
+        if (requestFrom < _from)
+        {
+            auto remaining = entry;
+            remaining.to = _from - 1;
+            m_requests[requestFrom] = remaining;
+        }
+        if (entry.to > _to)
+        {
+            auto remaining = entry;
+            remaining.from = _to + 1;
+            m_requests[_to + 1] = remaining;
+        }
+    }
+    return removedRequests;
+}
+
+BlockRequestEntries BlockRequestTracker::expire()
+{
+    BlockRequestEntries expiredRequests;
+    auto now = utcTime();
+    Guard l(m_mutex);
+    for (auto it = m_requests.begin(); it != m_requests.end();)
+    {
+        if (it->second.deadline > now)
+        {
+            it++;
+            continue;
+        }
+        expiredRequests.emplace_back(it->second);
+        it = m_requests.erase(it);
+    }
+    return expiredRequests;
+}
+
+void BlockRequestTracker::clearExpired(BlockNumber _blockNumber)
+{
+    Guard l(m_mutex);
+    if (m_requests.empty() || m_requests.begin()->first > _blockNumber)
+    {
+        return;
+    }
+    removeRange(m_requests.begin()->first, _blockNumber);
+}
+
+void BlockRequestTracker::clear()
+{
+    Guard l(m_mutex);
+    m_requests.clear();
+}
+
+BlockRanges BlockRequestTracker::excludeInFlight(BlockRanges const& _ranges) const
+{
+    BlockRanges result;
+    Guard l(m_mutex);
+    for (auto const& range : _ranges)
+    {
+        auto current = range.first;
+        auto it = m_requests.upper_bound(range.first);
+        if (it != m_requests.begin())
+        {
+            it--;
+        }
+        for (; it != m_requests.end() && it->first <= range.second; it++)
+        {
+            if (it->second.to < current)
+            {
+                continue;
+            }
+            if (it->first > current)
+            {
+                result.emplace_back(current, it->first - 1);
+            }
+            current = it->second.to + 1;
+            if (current > range.second)
+            {
+                break;
+            }
+        }
+        if (current <= range.second)
+        {
+            result.emplace_back(current, range.second);
+        }
+    }
+    return result;
+}
+
+BlockRequestEntries BlockRequestTracker::requests() const
+{
+    BlockRequestEntries requests;
+    Guard l(m_mutex);
+    requests.reserve(m_requests.size());
+    for (auto const& it : m_requests)
+    {
+        requests.emplace_back(it.second);
+    }
+    return requests;
+}
+
+size_t BlockRequestTracker::inFlightBlocks() const
+{
+    Guard l(m_mutex);
+    size_t blocks = 0;
+    for (auto const& it : m_requests)
+    {
+        blocks += (it.second.to - it.first + 1);
+    }
+    return blocks;
+}
+
+size_t BlockRequestTracker::inFlightBlocks(bcos::crypto::NodeIDPtr _peer) const
+{
+    Guard l(m_mutex);
+    size_t blocks = 0;
+    for (auto const& it : m_requests)
+    {
+        if (it.second.peer->data() == _peer->data())
+        {
+            blocks += (it.second.to - it.first + 1);
+        }
+    }
+    return blocks;
+}
+
+bool BlockRequestTracker::empty() const
+{
+    Guard l(m_mutex);
+    return m_requests.empty();
+}
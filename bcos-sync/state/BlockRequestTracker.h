@@ -0,0 +1,85 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief track the requested block ranges that have not been received
+ * @file BlockRequestTracker.h
+ * @author: yujiechen
+ * @date 2021-06-17
+ */
+#pragma once
+#include "bcos-sync/BlockSyncConfig.h"
+#include "bcos-sync/state/BlockWindow.h"
+namespace bcos
+{
+namespace sync
+{
+// the block request [from, to] sent to the peer
+struct BlockRequestEntry
+{
+    bcos::crypto::NodeIDPtr peer;
+    bcos::protocol::BlockNumber from;
+    bcos::protocol::BlockNumber to;
+    uint64_t sendTime;
+    uint64_t deadline;
+};
+using BlockRequestEntries = std::vector<BlockRequestEntry>;
+
+// the requested ranges never overlap, a number is:
+// 1. received: the block is in the downloading queue
+// 2. in-flight: the number is covered by a requested range that has not timed out
+// 3. missing: neither received nor in-flight, should be requested again
+class BlockRequestTracker
+{
+public:
+    using Ptr = std::shared_ptr<BlockRequestTracker>;
+    explicit BlockRequestTracker(BlockSyncConfig::Ptr _config) : m_config(_config) {}
+    virtual ~BlockRequestTracker() {}
+
+    // the blocks [_from, _to] have been requested from _peer
+    virtual void onRequested(bcos::crypto::NodeIDPtr _peer, bcos::protocol::BlockNumber _from,
+        bcos::protocol::BlockNumber _to);
+    // receive _size blocks start from _from, return the requests covering the received blocks
+    virtual BlockRequestEntries onReceived(bcos::protocol::BlockNumber _from, size_t _size);
+
+    // remove and return the requests that have timed out
+    virtual BlockRequestEntries expire();
+    // remove the requested blocks not larger than _blockNumber
+    virtual void clearExpired(bcos::protocol::BlockNumber _blockNumber);
+    virtual void clear();
+
+    // remove the in-flight numbers from the given ranges
+    virtual BlockRanges excludeInFlight(BlockRanges const& _ranges) const;
+
+    // the in-flight requests ordered by the block number
+    virtual BlockRequestEntries requests() const;
+    virtual size_t inFlightBlocks() const;
+    // the number of blocks requested from _peer but not received
+    virtual size_t inFlightBlocks(bcos::crypto::NodeIDPtr _peer) const;
+    virtual bool empty() const;
+
+protected:
+    // remove [_from, _to] from the requested ranges and return the requests covering them,
+    // the caller should hold the lock
+    BlockRequestEntries removeRange(
+        bcos::protocol::BlockNumber _from, bcos::protocol::BlockNumber _to);
+
+private:
+    BlockSyncConfig::Ptr m_config;
+    // from => the in-flight request
+    std::map<bcos::protocol::BlockNumber, BlockRequestEntry> m_requests;
+    mutable Mutex m_mutex;
+};
+}  // namespace sync
+}  // namespace bcos
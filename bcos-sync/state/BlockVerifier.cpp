@@ -0,0 +1,182 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief verify the downloaded blocks by the consensus ahead of the execution
+ * @file BlockVerifier.cpp
+ * @author: yujiechen
+ * @date 2021-06-23
+ */
+#include "BlockVerifier.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+
+bool BlockVerifier::matches(VerifyEntry::Ptr _entry, uint64_t _consensusListVersion,
+    SignatureList const& _signatureList) const
+{
+    if (_entry->consensusListVersion != _consensusListVersion ||
+        _entry->signatureList.size() != _signatureList.size())
+    {
+        return false;
+    }
+    for (size_t i = 0; i < _signatureList.size(); i++)
+    {
+        if (_entry->signatureList[i].index != _signatureList[i].index ||
+            _entry->signatureList[i].signature != _signatureList[i].signature)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+BlockVerifier::VerifyResult BlockVerifier::result(Block::Ptr _block) const
+{
+    auto version = m_config->consensusListVersion();
+    auto blockHeader = _block->blockHeader();
+    auto signatureList = blockHeader->signatureList();
+    Guard l(m_mutex);
+    auto it = m_entries.find(blockHeader->hash());
+    if (it == m_entries.end() || !matches(it->second, version, signatureList))
+    {
+        return VerifyResult::Unverified;
+    }
+    return it->second->result;
+}
+
+void BlockVerifier::asyncCheckBlock(
+    Block::Ptr _block, std::function<void(Error::Ptr, bool)> _onChecked)
+{
+    auto entry = verify(_block);
+    Error::Ptr error;
+    bool ret = false;
+    {
+        Guard l(m_mutex);
+        if (entry->result == VerifyResult::Verifying)
+        {
+            entry->onVerified.emplace_back(_onChecked);
+            return;
+        }
+        error = entry->error;
+        ret = (entry->result == VerifyResult::Valid);
+    }
+    _onChecked(error, ret);
+}
+
+BlockVerifier::VerifyEntry::Ptr BlockVerifier::verify(Block::Ptr _block)
+{
+    auto blockHeader = _block->blockHeader();
+    auto entry = std::make_shared<VerifyEntry>();
+    entry->number = blockHeader->number();
+    entry->consensusListVersion = m_config->consensusListVersion();
+    entry->signatureList = blockHeader->signatureList();
+    {
+        Guard l(m_mutex);
+        auto it = m_entries.find(blockHeader->hash());
+        if (it != m_entries.end() &&
+            matches(it->second, entry->consensusListVersion, entry->signatureList) &&
+            it->second->result != VerifyResult::Unverified)
+        {
+            return it->second;
+        }
+        // the copy of the valid block with other signatures is verified without cached, to
+        // not evict the valid result by the forged signatures
+        if (it == m_entries.end() ||
+            it->second->consensusListVersion != entry->consensusListVersion ||
+            it->second->result != VerifyResult::Valid)
+        {
+            m_entries[blockHeader->hash()] = entry;
+        }
+    }
+    auto self = std::weak_ptr<BlockVerifier>(shared_from_this());
+    m_config->consensus()->asyncCheckBlock(
+        _block, [self, entry, blockHeader](Error::Ptr _error, bool _ret) {
+            try
+            {
+                auto verifier = self.lock();
+                if (!verifier)
+                {
+                    return;
+                }
+                verifier->onVerified(entry, _error, _ret);
+            }
+            catch (std::exception const& e)
+            {
+                BLKSYNC_LOG(WARNING) << LOG_DESC("BlockVerifier: asyncCheckBlock exception")
+                                     << LOG_KV("blockNumber", blockHeader->number())
+                                     << LOG_KV("hash", blockHeader->hash().abridged())
+                                     << LOG_KV("error", boost::diagnostic_information(e));
+            }
+        });
+    return entry;
+}
+
+void BlockVerifier::onVerified(VerifyEntry::Ptr _entry, Error::Ptr _error, bool _ret)
+{
+    std::vector<std::function<void(Error::Ptr, bool)>> onVerified;
+    {
+        Guard l(m_mutex);
+        _entry->error = _error;
+        // the block failed to be verified with error will be verified again
+        if (_error)
+        {
+            _entry->result = VerifyResult::Unverified;
+        }
+        else
+        {
+            _entry->result = _ret ? VerifyResult::Valid : VerifyResult::Invalid;
+        }
+        onVerified.swap(_entry->onVerified);
+    }
+    if (_error || !_ret)
+    {
+        BLKSYNC_LOG(WARNING) << LOG_DESC("BlockVerifier: verify block failed")
+                             << LOG_KV("blockNumber", _entry->number)
+                             << LOG_KV("code", _error ? _error->errorCode() : 0)
+                             << LOG_KV("msg", _error ? _error->errorMessage() : "")
+                             << LOG_KV("consensusListVersion", _entry->consensusListVersion);
+    }
+    for (auto const& callback : onVerified)
+    {
+        callback(_error, _ret);
+    }
+}
+
+void BlockVerifier::clearExpired(BlockNumber _blockNumber)
+{
+    Guard l(m_mutex);
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        if (it->second->number <= _blockNumber)
+        {
+            it = m_entries.erase(it);
+            continue;
+        }
+        it++;
+    }
+}
+
+void BlockVerifier::clear()
+{
+    Guard l(m_mutex);
+    m_entries.clear();
+}
+
+size_t BlockVerifier::size() const
+{
+    Guard l(m_mutex);
+    return m_entries.size();
+}
@@ -0,0 +1,86 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief verify the downloaded blocks by the consensus ahead of the execution
+ * @file BlockVerifier.h
+ * @author: yujiechen
+ * @date 2021-06-23
+ */
+#pragma once
+#include "bcos-sync/BlockSyncConfig.h"
+#include "bcos-sync/utilities/Common.h"
+#include <bcos-framework/interfaces/protocol/Block.h>
+namespace bcos
+{
+namespace sync
+{
+// the signature lists of the downloaded blocks are checked by the consensus concurrently before
+// the blocks are executed, the results are cached by the block hash with the version of the
+// consensus node list, and only used while the consensus node list is unchanged,
+// Note: the block hash excludes the signature list, so the cached result is only used for the
+// block with the same signature list, and the valid result is never replaced by another copy
+class BlockVerifier : public std::enable_shared_from_this<BlockVerifier>
+{
+public:
+    using Ptr = std::shared_ptr<BlockVerifier>;
+    enum VerifyResult : int32_t
+    {
+        Unverified = 0x00,
+        Verifying = 0x01,
+        Valid = 0x02,
+        Invalid = 0x03,
+    };
+    explicit BlockVerifier(BlockSyncConfig::Ptr _config) : m_config(_config) {}
+    virtual ~BlockVerifier() {}
+
+    // verify the block if it has not been verified under the current consensus node list
+    virtual void asyncVerify(bcos::protocol::Block::Ptr _block) { verify(_block); }
+    // the result of the block verified under the current consensus node list
+    virtual VerifyResult result(bcos::protocol::Block::Ptr _block) const;
+    // check the block with the cached result, or wait for the verification
+    virtual void asyncCheckBlock(
+        bcos::protocol::Block::Ptr _block, std::function<void(Error::Ptr, bool)> _onChecked);
+
+    // remove the results of the blocks not larger than _blockNumber
+    virtual void clearExpired(bcos::protocol::BlockNumber _blockNumber);
+    virtual void clear();
+    size_t size() const;
+
+protected:
+    struct VerifyEntry
+    {
+        using Ptr = std::shared_ptr<VerifyEntry>;
+        bcos::protocol::BlockNumber number;
+        uint64_t consensusListVersion;
+        bcos::protocol::SignatureList signatureList;
+        VerifyResult result = VerifyResult::Verifying;
+        Error::Ptr error;
+        std::vector<std::function<void(Error::Ptr, bool)>> onVerified;
+    };
+    // return the entry of the block under the current consensus node list, the verification
+    // is started if the block has not been verified or failed with error
+    virtual VerifyEntry::Ptr verify(bcos::protocol::Block::Ptr _block);
+    virtual void onVerified(VerifyEntry::Ptr _entry, Error::Ptr _error, bool _ret);
+    // the cached entry can be used for the block with _signatureList
+    bool matches(VerifyEntry::Ptr _entry, uint64_t _consensusListVersion,
+        bcos::protocol::SignatureList const& _signatureList) const;
+
+private:
+    BlockSyncConfig::Ptr m_config;
+    std::map<bcos::crypto::HashType, VerifyEntry::Ptr> m_entries;
+    mutable Mutex m_mutex;
+};
+}  // namespace sync
+}  // namespace bcos
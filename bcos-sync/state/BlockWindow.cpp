@@ -0,0 +1,196 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief number-indexed sliding window to store the downloaded blocks
+ * @file BlockWindow.cpp
+ * @author: yujiechen
+ * @date 2021-06-16
+ */
+#include "BlockWindow.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+
+BlockWindow::BlockWindow(size_t _capacity) : m_blocks(std::max(_capacity, (size_t)1)) {}
+
+bool BlockWindow::insert(Block::Ptr _block)
+{
+    // Note: the number is only read once here, all the other operations are indexed by number
+    auto number = _block->blockHeader()->number();
+    if (!inWindow(number))
+    {
+        return false;
+    }
+    auto& slot = m_blocks[index(number)];
+    if (slot)
+    {
+        return false;
+    }
+    slot = _block;
+    m_size++;
+    if (m_size == 1 || number < m_topNumber)
+    {
+        m_topNumber = number;
+    }
+    return true;
+}
+
+Block::Ptr BlockWindow::get(BlockNumber _number) const
+{
+    if (!inWindow(_number))
+    {
+        return nullptr;
+    }
+    return m_blocks[index(_number)];
+}
+
+bool BlockWindow::contains(BlockNumber _number) const
+{
+    return get(_number) != nullptr;
+}
+
+void BlockWindow::erase(BlockNumber _number)
+{
+    if (!contains(_number))
+    {
+        return;
+    }
+    m_blocks[index(_number)] = nullptr;
+    m_size--;
+    if (_number == m_topNumber)
+    {
+        resetTopNumber(_number + 1);
+    }
+}
+
+Block::Ptr BlockWindow::top() const
+{
+    if (empty())
+    {
+        return nullptr;
+    }
+    return m_blocks[index(m_topNumber)];
+}
+
+void BlockWindow::pop()
+{
+    if (empty())
+    {
+        return;
+    }
+    erase(m_topNumber);
+}
+
+void BlockWindow::resetTopNumber(BlockNumber _from)
+{
+    if (empty())
+    {
+        m_topNumber = -1;
+        return;
+    }
+    auto end = m_base + (BlockNumber)capacity();
+    for (auto number = std::max(_from, m_base); number < end; number++)
+    {
+        if (m_blocks[index(number)])
+        {
+            m_topNumber = number;
+            return;
+        }
+    }
+}
+
+void BlockWindow::setBase(BlockNumber _base)
+{
+    if (_base == m_base)
+    {
+        return;
+    }
+    // drop the blocks fall out of the window
+    auto capacity = (BlockNumber)this->capacity();
+    BlockNumber dropFrom = m_base;
+    BlockNumber dropTo = std::min(_base, m_base + capacity);
+    if (_base < m_base)
+    {
+        dropFrom = std::max(_base + capacity, m_base);
+        dropTo = m_base + capacity;
+    }
+    for (auto number = dropFrom; number < dropTo && !empty(); number++)
+    {
+        auto& slot = m_blocks[index(number)];
+        if (slot)
+        {
+            slot = nullptr;
+            m_size--;
+        }
+    }
+    m_base = _base;
+    resetTopNumber(m_base);
+}
+
+void BlockWindow::resize(size_t _capacity)
+{
+    _capacity = std::max(_capacity, (size_t)1);
+    if (_capacity == capacity())
+    {
+        return;
+    }
+    auto end = m_base + (BlockNumber)std::min(_capacity, capacity());
+    std::vector<Block::Ptr> blocks(_capacity);
+    size_t size = 0;
+    for (auto number = m_base; number < end && size < m_size; number++)
+    {
+        auto& slot = m_blocks[index(number)];
+        if (slot)
+        {
+            blocks[(size_t)number % _capacity] = slot;
+            size++;
+        }
+    }
+    m_blocks.swap(blocks);
+    m_size = size;
+    resetTopNumber(m_base);
+}
+
+BlockRanges BlockWindow::missingRanges(BlockNumber _from, BlockNumber _to) const
+{
+    BlockRanges ranges;
+    auto from = std::max(_from, m_base);
+    auto to = std::min(_to, m_base + (BlockNumber)capacity() - 1);
+    for (auto number = from; number <= to; number++)
+    {
+        if (m_blocks[index(number)])
+        {
+            continue;
+        }
+        if (!ranges.empty() && ranges.back().second == number - 1)
+        {
+            ranges.back().second = number;
+            continue;
+        }
+        ranges.emplace_back(number, number);
+    }
+    return ranges;
+}
+
+void BlockWindow::clear()
+{
+    for (auto& slot : m_blocks)
+    {
+        slot = nullptr;
+    }
+    m_size = 0;
+    m_topNumber = -1;
+}
@@ -0,0 +1,82 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief number-indexed sliding window to store the downloaded blocks
+ * @file BlockWindow.h
+ * @author: yujiechen
+ * @date 2021-06-16
+ */
+#pragma once
+#include <bcos-framework/interfaces/protocol/Block.h>
+namespace bcos
+{
+namespace sync
+{
+using BlockRange = std::pair<bcos::protocol::BlockNumber, bcos::protocol::BlockNumber>;
+using BlockRanges = std::vector<BlockRange>;
+// stores at most one block for every number in [base, base + capacity)
+// Note: not thread-safe, the caller should hold the lock
+class BlockWindow
+{
+public:
+    using Ptr = std::shared_ptr<BlockWindow>;
+    explicit BlockWindow(size_t _capacity);
+    virtual ~BlockWindow() {}
+
+    // return false if the block is out of the window or already exists
+    virtual bool insert(bcos::protocol::Block::Ptr _block);
+    virtual bcos::protocol::Block::Ptr get(bcos::protocol::BlockNumber _number) const;
+    virtual bool contains(bcos::protocol::BlockNumber _number) const;
+    virtual void erase(bcos::protocol::BlockNumber _number);
+
+    // the block with the smallest number
+    virtual bcos::protocol::Block::Ptr top() const;
+    virtual bcos::protocol::BlockNumber topNumber() const { return m_topNumber; }
+    virtual void pop();
+
+    // move the window to [_base, _base + capacity), the blocks out of the window are dropped
+    virtual void setBase(bcos::protocol::BlockNumber _base);
+    bcos::protocol::BlockNumber base() const { return m_base; }
+    // change the capacity, the blocks out of [base, base + _capacity) are dropped
+    virtual void resize(size_t _capacity);
+    // the closed ranges of the numbers in [_from, _to] that have no block, clipped by the window
+    virtual BlockRanges missingRanges(
+        bcos::protocol::BlockNumber _from, bcos::protocol::BlockNumber _to) const;
+
+    virtual void clear();
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_blocks.size(); }
+    bool full() const { return m_size == m_blocks.size(); }
+
+protected:
+    size_t index(bcos::protocol::BlockNumber _number) const
+    {
+        return (size_t)_number % m_blocks.size();
+    }
+    bool inWindow(bcos::protocol::BlockNumber _number) const
+    {
+        return _number >= m_base && _number < m_base + (bcos::protocol::BlockNumber)capacity();
+    }
+    void resetTopNumber(bcos::protocol::BlockNumber _from);
+
+private:
+    std::vector<bcos::protocol::Block::Ptr> m_blocks;
+    bcos::protocol::BlockNumber m_base = 0;
+    bcos::protocol::BlockNumber m_topNumber = -1;
+    size_t m_size = 0;
+};
+}  // namespace sync
+}  // namespace bcos
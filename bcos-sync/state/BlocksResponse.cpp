@@ -0,0 +1,170 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief pack the fetched blocks of a requested range into BlocksMsgs
+ * @file BlocksResponse.cpp
+ * @author: yujiechen
+ * @date 2021-06-19
+ */
+#include "BlocksResponse.h"
+#include "bcos-sync/utilities/Common.h"
+#include "bcos-sync/utilities/ZstdCompress.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+
+BlocksResponse::BlocksResponse(BlockSyncConfig::Ptr _config, bcos::crypto::NodeIDPtr _peer,
+    BlockNumber _from, size_t _size, int32_t _compressType)
+  : m_config(_config),
+    m_peer(_peer),
+    m_from(_from),
+    m_size(_size),
+    m_compressType(_compressType),
+    m_blocks(_size),
+    m_rawSizes(_size, 0),
+    m_fetched(_size, false)
+{}
+
+void BlocksResponse::onBlockFetched(BlockNumber _number, bytesConstPtr _blockData)
+{
+    if (_number < m_from || _number >= m_from + (BlockNumber)m_size)
+    {
+        return;
+    }
+    // compress outside the lock, the blocks are fetched concurrently
+    int64_t rawSize = 0;
+    auto compressedData = compressBlockData(_blockData);
+    if (compressedData)
+    {
+        rawSize = _blockData->size();
+        _blockData = compressedData;
+    }
+    // the packed BlocksMsgs and the failed blocks are taken out under the lock, and sent or
+    // reported after the lock released, to not block the other fetching threads
+    std::vector<PackedBlocksMsg> packedMsgs;
+    std::vector<BlockNumber> failedBlocks;
+    {
+        Guard l(m_mutex);
+        auto index = _number - m_from;
+        m_blocks[index] = _blockData;
+        m_rawSizes[index] = rawSize;
+        m_fetched[index] = true;
+        // pack the fetched prefix in order
+        while (m_nextIndex < m_size && m_fetched[m_nextIndex])
+        {
+            auto blockNumber = m_from + (BlockNumber)m_nextIndex;
+            auto blockData = m_blocks[m_nextIndex];
+            auto rawSize = m_rawSizes[m_nextIndex];
+            m_blocks[m_nextIndex] = nullptr;
+            m_nextIndex++;
+            // the blocks of a BlocksMsg must be consecutive
+            if (!blockData)
+            {
+                takeBlocksMsg(packedMsgs);
+                failedBlocks.emplace_back(blockNumber);
+                continue;
+            }
+            if (m_blocksMsg &&
+                m_blocksMsgSize + blockData->size() > m_config->maxBlocksMsgSize())
+            {
+                takeBlocksMsg(packedMsgs);
+            }
+            if (!m_blocksMsg)
+            {
+                m_blocksMsg = m_config->msgFactory()->createBlocksMsg();
+                m_blocksMsg->setVersion(c_blockSyncVersion);
+                m_blocksMsg->setBlockFlag(m_blockFlag);
+                m_blocksMsg->setNumber(blockNumber);
+                m_blocksMsgSize = 0;
+            }
+            m_blocksMsgSize += blockData->size();
+            if (rawSize > 0)
+            {
+                m_blocksMsg->setCompressType(m_compressType);
+                m_blocksMsg->appendCompressedBlockData(blockData, rawSize);
+                continue;
+            }
+            m_blocksMsg->appendBlockData(blockData);
+        }
+        if (m_nextIndex == m_size)
+        {
+            takeBlocksMsg(packedMsgs);
+        }
+    }
+    for (auto const& packedMsg : packedMsgs)
+    {
+        sendBlocksMsg(packedMsg);
+    }
+    if (!m_fetchFailedHandler)
+    {
+        return;
+    }
+    for (auto blockNumber : failedBlocks)
+    {
+        m_fetchFailedHandler(blockNumber);
+    }
+}
+
+void BlocksResponse::takeBlocksMsg(std::vector<PackedBlocksMsg>& _packedMsgs)
+{
+    if (!m_blocksMsg)
+    {
+        return;
+    }
+    _packedMsgs.emplace_back(m_blocksMsg, m_blocksMsgSize);
+    m_blocksMsg = nullptr;
+    m_blocksMsgSize = 0;
+}
+
+void BlocksResponse::sendBlocksMsg(PackedBlocksMsg const& _packedMsg)
+{
+    auto const& blocksMsg = _packedMsg.first;
+    m_config->frontService()->asyncSendMessageByNodeID(
+        ModuleID::BlockSync, m_peer, ref(*(blocksMsg->encode())), 0, nullptr);
+    BLKSYNC_LOG(DEBUG) << LOG_DESC("BlocksResponse: response blocks")
+                       << LOG_KV("toPeer", m_peer->shortHex())
+                       << LOG_KV("from", blocksMsg->number())
+                       << LOG_KV("blocks", blocksMsg->blocksSize())
+                       << LOG_KV("size", _packedMsg.second)
+                       << LOG_KV("compressType", blocksMsg->compressType());
+}
+
+bytesConstPtr BlocksResponse::compressBlockData(bytesConstPtr _blockData)
+{
+    auto threshold = m_config->compressThreshold();
+    if (!_blockData || m_compressType != BlockCompressType::CompressZstd || threshold == 0 ||
+        _blockData->size() < threshold)
+    {
+        return nullptr;
+    }
+    auto compressedData = std::make_shared<bytes>();
+    if (!ZstdCompress::compress(ref(*_blockData), *compressedData))
+    {
+        return nullptr;
+    }
+    // the incompressible block is sent as it is
+    if (compressedData->size() >= _blockData->size())
+    {
+        return nullptr;
+    }
+    return compressedData;
+}
+
+bool BlocksResponse::finished() const
+{
+    Guard l(m_mutex);
+    return m_nextIndex == m_size;
+}
@@ -0,0 +1,86 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief pack the fetched blocks of a requested range into BlocksMsgs
+ * @file BlocksResponse.h
+ * @author: yujiechen
+ * @date 2021-06-19
+ */
+#pragma once
+#include "bcos-sync/BlockSyncConfig.h"
+#include "bcos-sync/interfaces/BlocksMsgInterface.h"
+#include "bcos-sync/utilities/Common.h"
+namespace bcos
+{
+namespace sync
+{
+// the blocks of [from, from + size) are fetched concurrently, and sent to the peer in order,
+// the consecutive blocks are packed into one BlocksMsg until maxBlocksMsgSize is reached,
+// the blocks not smaller than compressThreshold are compressed if _compressType is set
+class BlocksResponse
+{
+public:
+    using Ptr = std::shared_ptr<BlocksResponse>;
+    BlocksResponse(BlockSyncConfig::Ptr _config, bcos::crypto::NodeIDPtr _peer,
+        bcos::protocol::BlockNumber _from, size_t _size,
+        int32_t _compressType = BlockCompressType::CompressNone);
+    virtual ~BlocksResponse() {}
+
+    // the encoded block has been fetched, nullptr means failed to fetch the block
+    virtual void onBlockFetched(bcos::protocol::BlockNumber _number, bytesConstPtr _blockData);
+
+    // called for the blocks failed to be fetched
+    virtual void registerFetchFailedHandler(
+        std::function<void(bcos::protocol::BlockNumber)> _fetchFailedHandler)
+    {
+        m_fetchFailedHandler = _fetchFailedHandler;
+    }
+
+    virtual bool finished() const;
+
+    // the parts of the fetched blocks
+    void setBlockFlag(int32_t _blockFlag) { m_blockFlag = _blockFlag; }
+
+protected:
+    // the packed BlocksMsg and its size in bytes
+    using PackedBlocksMsg = std::pair<BlocksMsgInterface::Ptr, size_t>;
+    // move the BlocksMsg being packed into _packedMsgs, the caller should hold the lock
+    virtual void takeBlocksMsg(std::vector<PackedBlocksMsg>& _packedMsgs);
+    // encode and send the packed blocks, called without holding the lock
+    virtual void sendBlocksMsg(PackedBlocksMsg const& _packedMsg);
+    // return nullptr if the block should be sent without compressed
+    virtual bytesConstPtr compressBlockData(bytesConstPtr _blockData);
+
+private:
+    BlockSyncConfig::Ptr m_config;
+    bcos::crypto::NodeIDPtr m_peer;
+    bcos::protocol::BlockNumber m_from;
+    size_t m_size;
+    int32_t m_compressType;
+    int32_t m_blockFlag = 0;
+    std::function<void(bcos::protocol::BlockNumber)> m_fetchFailedHandler;
+
+    std::vector<bytesConstPtr> m_blocks;
+    // the size of the compressed block before compressed, 0 means not compressed
+    std::vector<int64_t> m_rawSizes;
+    std::vector<bool> m_fetched;
+    // the index of the next block to be packed
+    size_t m_nextIndex = 0;
+    BlocksMsgInterface::Ptr m_blocksMsg;
+    size_t m_blocksMsgSize = 0;
+    mutable Mutex m_mutex;
+};
+}  // namespace sync
+}  // namespace bcos
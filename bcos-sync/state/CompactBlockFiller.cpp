@@ -0,0 +1,160 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief fill the transactions of the compact blocks from the txpool
+ * @file CompactBlockFiller.cpp
+ * @author: yujiechen
+ * @date 2021-06-22
+ */
+#include "CompactBlockFiller.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+using namespace bcos::crypto;
+
+CompactBlockFiller::CompactBlockFiller(
+    BlockSyncConfig::Ptr _config, BlocksMsgInterface::Ptr _blocksMsg)
+  : m_config(_config),
+    m_blocksMsg(_blocksMsg),
+    m_blocks(_blocksMsg->blocksSize()),
+    m_blockSizes(_blocksMsg->blocksSize(), 0),
+    m_pendingBlocks(_blocksMsg->blocksSize())
+{}
+
+void CompactBlockFiller::fill(FilledHandler _onFilled)
+{
+    m_onFilled = _onFilled;
+    if (m_blocks.empty())
+    {
+        m_onFilled(m_blocks, m_blockSizes);
+        return;
+    }
+    for (size_t i = 0; i < m_blocks.size(); i++)
+    {
+        auto block = decodeBlock(i);
+        if (!block || block->transactionsHashSize() == 0)
+        {
+            onBlockFilled(i, block, 0);
+            continue;
+        }
+        fillBlock(i, block);
+    }
+}
+
+Block::Ptr CompactBlockFiller::decodeBlock(size_t _index)
+{
+    auto expectedNumber = m_blocksMsg->number() + (BlockNumber)_index;
+    try
+    {
+        // the compact blocks are sent without compressed
+        if (m_blocksMsg->blockRawSize(_index) > 0)
+        {
+            BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("CompactBlockFiller")
+                                 << LOG_DESC("Receive compressed compact block")
+                                 << LOG_KV("number", expectedNumber);
+            return nullptr;
+        }
+        auto block =
+            m_config->blockFactory()->createBlock(m_blocksMsg->blockData(_index), true, false);
+        auto blockHeader = block->blockHeader();
+        if (!blockHeader || blockHeader->number() != expectedNumber ||
+            block->transactionsSize() > 0)
+        {
+            BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("CompactBlockFiller")
+                                 << LOG_DESC("Receive invalid compact block")
+                                 << LOG_KV("number", expectedNumber)
+                                 << LOG_KV("txsSize", block->transactionsSize());
+            return nullptr;
+        }
+        return block;
+    }
+    catch (std::exception const& e)
+    {
+        BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("CompactBlockFiller")
+                             << LOG_DESC("Decode compact block exception")
+                             << LOG_KV("number", expectedNumber)
+                             << LOG_KV("error", boost::diagnostic_information(e));
+    }
+    return nullptr;
+}
+
+void CompactBlockFiller::fillBlock(size_t _index, Block::Ptr _block)
+{
+    auto txsHash = std::make_shared<HashList>();
+    for (size_t i = 0; i < _block->transactionsHashSize(); i++)
+    {
+        txsHash->emplace_back(_block->transactionHash(i));
+    }
+    auto self = shared_from_this();
+    m_config->txpool()->asyncFillBlock(
+        txsHash, [self, _index, _block, txsHash](Error::Ptr _error, TransactionsPtr _txs) {
+            auto blockNumber = _block->blockHeader()->number();
+            try
+            {
+                // the txpool misses some transactions
+                if (_error || !_txs || _txs->size() != txsHash->size())
+                {
+                    BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("CompactBlockFiller")
+                                       << LOG_DESC("Fill compact block failed")
+                                       << LOG_KV("number", blockNumber)
+                                       << LOG_KV("txsSize", txsHash->size())
+                                       << LOG_KV("code", _error ? _error->errorCode() : 0);
+                    self->onBlockFilled(_index, nullptr, 0);
+                    return;
+                }
+                size_t txsSize = 0;
+                for (size_t i = 0; i < _txs->size(); i++)
+                {
+                    auto const& tx = (*_txs)[i];
+                    if (!tx || tx->hash() != (*txsHash)[i])
+                    {
+                        BLKSYNC_LOG(WARNING)
+                            << LOG_BADGE("Download") << LOG_BADGE("CompactBlockFiller")
+                            << LOG_DESC("Fill compact block failed for inconsistent transaction")
+                            << LOG_KV("number", blockNumber) << LOG_KV("index", i);
+                        self->onBlockFilled(_index, nullptr, 0);
+                        return;
+                    }
+                    _block->appendTransaction(tx);
+                    txsSize += tx->encode(false).size();
+                }
+                self->onBlockFilled(_index, _block, txsSize);
+            }
+            catch (std::exception const& e)
+            {
+                BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("CompactBlockFiller")
+                                     << LOG_DESC("Fill compact block exception")
+                                     << LOG_KV("number", blockNumber)
+                                     << LOG_KV("error", boost::diagnostic_information(e));
+                self->onBlockFilled(_index, nullptr, 0);
+            }
+        });
+}
+
+void CompactBlockFiller::onBlockFilled(size_t _index, Block::Ptr _block, size_t _txsSize)
+{
+    {
+        Guard l(m_mutex);
+        m_blocks[_index] = _block;
+        m_blockSizes[_index] = m_blocksMsg->blockData(_index).size() + _txsSize;
+        m_pendingBlocks--;
+        if (m_pendingBlocks > 0)
+        {
+            return;
+        }
+    }
+    m_onFilled(m_blocks, m_blockSizes);
+}
@@ -0,0 +1,62 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief fill the transactions of the compact blocks from the txpool
+ * @file CompactBlockFiller.h
+ * @author: yujiechen
+ * @date 2021-06-22
+ */
+#pragma once
+#include "bcos-sync/BlockSyncConfig.h"
+#include "bcos-sync/interfaces/BlocksMsgInterface.h"
+#include "bcos-sync/utilities/Common.h"
+namespace bcos
+{
+namespace sync
+{
+// the compact block carries the header and the transaction hashes only, the transactions are
+// filled from the local txpool concurrently, a block with any transaction missing in the txpool
+// is reported as nullptr and should be downloaded with the transactions
+class CompactBlockFiller : public std::enable_shared_from_this<CompactBlockFiller>
+{
+public:
+    using Ptr = std::shared_ptr<CompactBlockFiller>;
+    // the blocks of the BlocksMsg in order, and the estimated memory size of each block
+    using FilledHandler =
+        std::function<void(bcos::protocol::Blocks const&, std::vector<size_t> const&)>;
+    CompactBlockFiller(BlockSyncConfig::Ptr _config, BlocksMsgInterface::Ptr _blocksMsg);
+    virtual ~CompactBlockFiller() {}
+
+    // _onFilled is called once all the blocks have been filled or failed
+    virtual void fill(FilledHandler _onFilled);
+
+protected:
+    // decode the compact block, nullptr if the block is invalid
+    virtual bcos::protocol::Block::Ptr decodeBlock(size_t _index);
+    virtual void fillBlock(size_t _index, bcos::protocol::Block::Ptr _block);
+    virtual void onBlockFilled(size_t _index, bcos::protocol::Block::Ptr _block, size_t _txsSize);
+
+private:
+    BlockSyncConfig::Ptr m_config;
+    BlocksMsgInterface::Ptr m_blocksMsg;
+    FilledHandler m_onFilled;
+
+    bcos::protocol::Blocks m_blocks;
+    std::vector<size_t> m_blockSizes;
+    size_t m_pendingBlocks = 0;
+    mutable Mutex m_mutex;
+};
+}  // namespace sync
+}  // namespace bcos
@@ -27,24 +27,72 @@ using namespace bcos::protocol;
 
 void DownloadRequestQueue::push(BlockNumber _fromNumber, size_t _size)
 {
-    UpgradableGuard l(x_reqQueue);
-    // Note: the requester must has retry logic
-    if (m_reqQueue.size() >= m_config->maxDownloadRequestQueueSize())
+    if (_size == 0)
+    {
+        return;
+    }
+    auto from = _fromNumber;
+    auto to = _fromNumber + (BlockNumber)_size;
+    WriteGuard l(x_reqQueue);
+    auto capacity = m_config->maxDownloadRequestQueueSize();
+    auto available = (m_blocks < capacity) ? (capacity - m_blocks) : 0;
+    // the first range may overlap or be adjacent with [from, to)
+    auto it = m_ranges.upper_bound(from);
+    if (it != m_ranges.begin() && std::prev(it)->second >= from)
+    {
+        --it;
+    }
+    // count the blocks not in the queue, and cut [from, to) once the capacity reached
+    size_t newBlocks = 0;
+    auto cursor = from;
+    for (auto range = it; range != m_ranges.end() && cursor < to; ++range)
+    {
+        auto gap = (size_t)(std::max(std::min(range->first, to) - cursor, (BlockNumber)0));
+        if (newBlocks + gap > available)
+        {
+            to = cursor + (BlockNumber)(available - newBlocks);
+            newBlocks = available;
+            break;
+        }
+        newBlocks += gap;
+        cursor = std::max(cursor, range->second);
+    }
+    if (cursor < to)
+    {
+        auto gap = (size_t)(to - cursor);
+        if (newBlocks + gap > available)
+        {
+            to = cursor + (BlockNumber)(available - newBlocks);
+            gap = available - newBlocks;
+        }
+        newBlocks += gap;
+    }
+    if (to < _fromNumber + (BlockNumber)_size)
     {
         BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("Request")
-                           << LOG_DESC("Drop request for reqQueue full")
-                           << LOG_KV("reqQueueSize", m_reqQueue.size())
-                           << LOG_KV("fromNumber", _fromNumber) << LOG_KV("size", _size)
+                           << LOG_DESC("Drop the requested blocks for reqQueue full")
+                           << LOG_KV("queuedBlocks", m_blocks) << LOG_KV("fromNumber", _fromNumber)
+                           << LOG_KV("size", _size) << LOG_KV("droppedFrom", to)
                            << LOG_KV("nodeId", m_config->nodeID()->shortHex());
+    }
+    if (newBlocks == 0)
+    {
         return;
     }
-    UpgradeGuard ul(l);
-    m_reqQueue.push(std::make_shared<DownloadRequest>(_fromNumber, _size));
+    // merge the overlapping and adjacent ranges into [from, to)
+    while (it != m_ranges.end() && it->first <= to)
+    {
+        from = std::min(from, it->first);
+        to = std::max(to, it->second);
+        it = m_ranges.erase(it);
+    }
+    m_ranges.emplace(from, to);
+    m_blocks += newBlocks;
     BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("Request")
                        << LOG_DESC("Push request in reqQueue req") << LOG_KV("from", _fromNumber)
                        << LOG_KV("to", _fromNumber + _size - 1)
                        << LOG_KV("currentNumber", m_config->blockNumber())
-                       << LOG_KV("queueSize", m_reqQueue.size())
+                       << LOG_KV("ranges", m_ranges.size()) << LOG_KV("queuedBlocks", m_blocks)
                        << LOG_KV("peer", m_nodeId->shortHex())
                        << LOG_KV("nodeId", m_config->nodeID()->shortHex());
 }
@@ -52,29 +100,16 @@ void DownloadRequestQueue::push(BlockNumber _fromNumber, size_t _size)
 DownloadRequest::Ptr DownloadRequestQueue::topAndPop()
 {
     WriteGuard l(x_reqQueue);
-    if (m_reqQueue.empty())
+    if (m_ranges.empty())
     {
         return nullptr;
     }
-    // "Tops" means that the merge result of all tops can merge at one turn
-    // Example:
-    // top[x] (fromNumber, size)    range       merged range    merged tops(fromNumber, size)
-    // top[0] (1, 3)                [1, 4)      [1, 4)          (1, 3)
-    // top[1] (1, 4)                [1, 5)      [1, 5)          (1, 4)
-    // top[2] (2, 1)                [2, 3)      [1, 5)          (1, 4)
-    // top[3] (2, 4)                [2, 6)      [1, 6)          (1, 5)
-    // top[4] (6, 2)                [6, 8)      [1, 8)          (1, 7)
-    // top[5] (10, 2)               [10, 12]    can not merge into (1, 7) leave it for next turn
-    size_t fromNumber = m_reqQueue.top()->fromNumber();
-    size_t size = 0;
-    while (!m_reqQueue.empty() && (fromNumber + size) >= (size_t)(m_reqQueue.top()->fromNumber()))
-    {
-        auto topReq = m_reqQueue.top();
-        // m_queue is increasing by fromNumber, so fromNumber must no more than
-        // merged tops
-        size = std::max(size, (size_t)(topReq->fromNumber() + topReq->size() - fromNumber));
-        m_reqQueue.pop();
-    }
+    // the overlapping and adjacent requests have been merged once pushed
+    auto top = m_ranges.begin();
+    auto fromNumber = top->first;
+    auto size = (size_t)(top->second - top->first);
+    m_ranges.erase(top);
+    m_blocks -= size;
     BLKSYNC_LOG(TRACE) << LOG_BADGE("Download") << LOG_BADGE("Request")
                        << LOG_DESC("Pop reqQueue top req") << LOG_KV("from", fromNumber)
                        << LOG_KV("to", fromNumber + size - 1);
@@ -84,5 +119,17 @@ DownloadRequest::Ptr DownloadRequestQueue::topAndPop()
 bool DownloadRequestQueue::empty()
 {
     ReadGuard l(x_reqQueue);
-    return m_reqQueue.empty();
+    return m_ranges.empty();
+}
+
+size_t DownloadRequestQueue::size()
+{
+    ReadGuard l(x_reqQueue);
+    return m_ranges.size();
+}
+
+size_t DownloadRequestQueue::blocks()
+{
+    ReadGuard l(x_reqQueue);
+    return m_blocks;
 }
@@ -40,18 +40,8 @@ private:
     size_t m_size;
 };
 
-struct DownloadRequestCmp
-{
-    bool operator()(DownloadRequest::Ptr const& _first, DownloadRequest::Ptr const& _second)
-    {
-        if (_first->fromNumber() == _second->fromNumber())
-        {
-            return _first->size() < _second->size();
-        }
-        return _first->fromNumber() > _second->fromNumber();
-    }
-};
-
+// the requested blocks are kept as the disjoint ranges, the overlapping and adjacent ranges are
+// merged once pushed, and at most maxDownloadRequestQueueSize blocks are kept
 class DownloadRequestQueue
 {
 public:
@@ -61,16 +51,22 @@ public:
     {}
     virtual ~DownloadRequestQueue() {}
 
+    // the blocks beyond the capacity are dropped, the requester must has retry logic
     virtual void push(bcos::protocol::BlockNumber _fromNumber, size_t _size);
-    virtual DownloadRequest::Ptr topAndPop();  // Must call use disablePush() before
+    // pop the range with the smallest block number
+    virtual DownloadRequest::Ptr topAndPop();
     virtual bool empty();
+    // the number of the disjoint ranges waiting to be served
+    virtual size_t size();
+    // the number of the blocks waiting to be served
+    virtual size_t blocks();
 
 private:
     BlockSyncConfig::Ptr m_config;
     bcos::crypto::NodeIDPtr m_nodeId;
-    using RequestQueue = std::priority_queue<DownloadRequest::Ptr,
-        std::vector<DownloadRequest::Ptr>, DownloadRequestCmp>;
-    RequestQueue m_reqQueue;
+    // the first block => the last block + 1 of the range
+    std::map<bcos::protocol::BlockNumber, bcos::protocol::BlockNumber> m_ranges;
+    size_t m_blocks = 0;
     mutable SharedMutex x_reqQueue;
 };
 }  // namespace sync
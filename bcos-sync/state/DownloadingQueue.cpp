@@ -20,6 +20,9 @@
  */
 #include "DownloadingQueue.h"
 #include "bcos-sync/utilities/Common.h"
+#include "bcos-sync/utilities/ZstdCompress.h"
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #include <future>
 
 using namespace std;
@@ -28,7 +31,7 @@ using namespace bcos::protocol;
 using namespace bcos::sync;
 using namespace bcos::ledger;
 
-void DownloadingQueue::push(BlocksMsgInterface::Ptr _blocksData)
+void DownloadingQueue::push(BlocksMsgInterface::Ptr _blocksData, bcos::crypto::NodeIDPtr _peer)
 {
     // push to the blockBuffer firstly
     UpgradableGuard l(x_blockBuffer);
@@ -40,7 +43,17 @@ void DownloadingQueue::push(BlocksMsgInterface::Ptr _blocksData)
         return;
     }
     UpgradeGuard ul(l);
-    m_blockBuffer->emplace_back(_blocksData);
+    m_blockBuffer->emplace_back(_blocksData, _peer);
+}
+
+void DownloadingQueue::push(Block::Ptr _block, size_t _blockSize, bcos::crypto::NodeIDPtr _peer)
+{
+    if (m_blockChecker && !m_blockChecker(_peer, _block))
+    {
+        return;
+    }
+    m_executionWaterMark->onBlockDecoded(_blockSize);
+    flushBlocksToQueue(Blocks{_block});
 }
 
 bool DownloadingQueue::empty()
@@ -87,107 +100,379 @@ void DownloadingQueue::clear()
         WriteGuard l(x_blockBuffer);
         m_blockBuffer->clear();
     }
+    {
+        Guard l(x_storingTransactions);
+        m_storingTransactions.clear();
+    }
+    m_blockVerifier->clear();
     clearQueue();
 }
 
 void DownloadingQueue::clearQueue()
 {
     WriteGuard l(x_blocks);
-    BlockQueue emptyQueue;
-    swap(m_blocks, emptyQueue);  // Does memory leak here ?
+    m_blocks.clear();
 }
 
 void DownloadingQueue::flushBufferToQueue()
 {
-    WriteGuard l(x_blockBuffer);
-    bool ret = true;
-    while (m_blockBuffer->size() > 0 && ret)
+    auto blocksShards = fetchBufferedShards();
+    if (blocksShards->empty())
     {
-        auto blocksShard = m_blockBuffer->front();
-        m_blockBuffer->pop_front();
-        ret = flushOneShard(blocksShard);
+        return;
     }
+    // Note: decode the blocks outside the lock to avoid blocking top()/pop()
+    auto blocks = decodeShards(blocksShards);
+    flushBlocksToQueue(blocks);
 }
 
-bool DownloadingQueue::flushOneShard(BlocksMsgInterface::Ptr _blocksData)
+DownloadingQueue::BlocksMessageQueuePtr DownloadingQueue::fetchBufferedShards()
 {
-    // pop buffer into queue
+    auto blocksShards = std::make_shared<BlocksMessageQueue>();
+    WriteGuard bufferLock(x_blockBuffer);
     WriteGuard l(x_blocks);
-    if (m_blocks.size() >= m_config->maxDownloadingBlockQueueSize())
+    // the window starts from the next block to be committed
+    moveWindow(m_blocks, m_config->nextBlock());
+    if (m_blocks.full())
     {
         BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
                            << LOG_DESC("DownloadingBlockQueueBuffer is full")
                            << LOG_KV("queueSize", m_blocks.size());
+        return blocksShards;
+    }
+    // only the shards with the blocks missing in the window are decoded, at most the free slots
+    // of the window, the shards beyond the window are kept buffered until the window moves
+    auto windowFrom = m_blocks.base();
+    auto windowTo = windowFrom + (BlockNumber)m_blocks.capacity() - 1;
+    auto freeSlots = m_blocks.capacity() - m_blocks.size();
+    size_t missingBlocks = 0;
+    auto it = m_blockBuffer->begin();
+    while (it != m_blockBuffer->end() && missingBlocks < freeSlots)
+    {
+        auto from = it->first->number();
+        auto to = from + (BlockNumber)it->first->blocksSize() - 1;
+        if (from > windowTo)
+        {
+            it++;
+            continue;
+        }
+        // the expired or downloaded blocks are dropped
+        auto missingRanges = m_blocks.missingRanges(from, to);
+        if (to < windowFrom || missingRanges.empty())
+        {
+            it = m_blockBuffer->erase(it);
+            continue;
+        }
+        for (auto const& range : missingRanges)
+        {
+            missingBlocks += (range.second - range.first + 1);
+        }
+        blocksShards->emplace_back(std::move(*it));
+        it = m_blockBuffer->erase(it);
+    }
+    return blocksShards;
+}
 
-        return false;
+Blocks DownloadingQueue::decodeShards(BlocksMessageQueuePtr _blocksShards)
+{
+    // flatten the shards to decode all the blocks in parallel
+    std::vector<std::pair<BlocksMsgInterface::Ptr, size_t>> blocksData;
+    std::vector<bcos::crypto::NodeIDPtr> peers;
+    for (auto const& blocksShard : *_blocksShards)
+    {
+        for (size_t i = 0; i < blocksShard.first->blocksSize(); i++)
+        {
+            blocksData.emplace_back(std::make_pair(blocksShard.first, i));
+            peers.emplace_back(blocksShard.second);
+        }
     }
-    BLKSYNC_LOG(TRACE) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
-                       << LOG_DESC("Decoding block buffer")
-                       << LOG_KV("blocksShardSize", _blocksData->blocksSize());
-    size_t blocksSize = _blocksData->blocksSize();
-    for (size_t i = 0; i < blocksSize; i++)
+    auto startT = utcTime();
+    Blocks blocks(blocksData.size());
+    auto concurrency = std::max(m_config->blockDecodeConcurrency(), (size_t)1);
+    tbb::task_arena decodeArena(concurrency);
+    decodeArena.execute([&]() {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, blocksData.size()),
+            [&](tbb::blocked_range<size_t> const& _range) {
+                for (size_t i = _range.begin(); i < _range.end(); i++)
+                {
+                    auto const& blockData = blocksData[i];
+                    try
+                    {
+                        auto data = blockData.first->blockData(blockData.second);
+                        auto rawSize = blockData.first->blockRawSize(blockData.second);
+                        // uncompress the compressed block before decoding
+                        bytes rawData;
+                        if (rawSize > 0)
+                        {
+                            if (blockData.first->compressType() !=
+                                    BlockCompressType::CompressZstd ||
+                                !ZstdCompress::uncompress(data, rawData, rawSize))
+                            {
+                                BLKSYNC_LOG(WARNING)
+                                    << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                                    << LOG_DESC("Invalid compressed block data")
+                                    << LOG_KV("compressType", blockData.first->compressType())
+                                    << LOG_KV("blockDataSize", data.size())
+                                    << LOG_KV("rawSize", rawSize);
+                                continue;
+                            }
+                            data = ref(rawData);
+                        }
+                        blocks[i] = m_config->blockFactory()->createBlock(data, true, true);
+                    }
+                    catch (std::exception const& e)
+                    {
+                        BLKSYNC_LOG(WARNING)
+                            << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                            << LOG_DESC("Invalid block data")
+                            << LOG_KV("reason", boost::diagnostic_information(e))
+                            << LOG_KV("blockDataSize",
+                                   blockData.first->blockData(blockData.second).size());
+                    }
+                }
+            });
+    });
+    for (size_t i = 0; i < blocks.size(); i++)
     {
-        try
+        if (blocks[i] && m_blockChecker && !m_blockChecker(peers[i], blocks[i]))
         {
-            auto block =
-                m_config->blockFactory()->createBlock(_blocksData->blockData(i), true, true);
-            auto blockHeader = block->blockHeader();
-            if (isNewerBlock(block))
+            blocks[i] = nullptr;
+        }
+        if (blocks[i])
+        {
+            auto const& blockData = blocksData[i];
+            // the memory of the block is measured by the uncompressed size
+            size_t blockSize = blockData.first->blockRawSize(blockData.second);
+            if (blockSize == 0)
             {
-                m_blocks.push(block);
-                BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
-                                   << LOG_DESC("Flush block to the queue")
-                                   << LOG_KV("number", blockHeader->number())
-                                   << LOG_KV("nodeId", m_config->nodeID()->shortHex());
+                blockSize = blockData.first->blockData(blockData.second).size();
             }
+            m_executionWaterMark->onBlockDecoded(blockSize);
         }
-        catch (std::exception const& e)
+    }
+    BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                       << LOG_DESC("Decode block buffer") << LOG_KV("shards", _blocksShards->size())
+                       << LOG_KV("blocks", blocks.size()) << LOG_KV("concurrency", concurrency)
+                       << LOG_KV("decodeTimeCost", (utcTime() - startT));
+    return blocks;
+}
+
+void DownloadingQueue::moveWindow(BlockWindow& _window, BlockNumber _nextBlock)
+{
+    // the capacity follows maxDownloadingBlockQueueSize
+    _window.resize(m_config->maxDownloadingBlockQueueSize());
+    _window.setBase(std::max(_window.base(), _nextBlock));
+}
+
+void DownloadingQueue::flushBlocksToQueue(Blocks const& _blocks)
+{
+    WriteGuard l(x_blocks);
+    // the window starts from the next block to be committed
+    moveWindow(m_blocks, m_config->nextBlock());
+    for (auto const& block : _blocks)
+    {
+        // invalid block
+        if (!block)
         {
-            BLKSYNC_LOG(WARNING) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
-                                 << LOG_DESC("Invalid block data")
-                                 << LOG_KV("reason", boost::diagnostic_information(e))
-                                 << LOG_KV("blockDataSize", _blocksData->blockData(i).size());
             continue;
         }
+        if (!isNewerBlock(block))
+        {
+            continue;
+        }
+        // Note: the block out of the window or already downloaded will be ignored
+        if (m_blocks.insert(block))
+        {
+            BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
+                               << LOG_DESC("Flush block to the queue")
+                               << LOG_KV("number", block->blockHeader()->number())
+                               << LOG_KV("nodeId", m_config->nodeID()->shortHex());
+        }
     }
     if (m_blocks.size() == 0)
     {
-        return true;
+        return;
     }
     BLKSYNC_LOG(DEBUG) << LOG_BADGE("Download") << LOG_BADGE("BlockSync")
-                       << LOG_DESC("Flush buffer to block queue") << LOG_KV("rcv", blocksSize)
-                       << LOG_KV("top", m_blocks.top()->blockHeader()->number())
+                       << LOG_DESC("Flush buffer to block queue") << LOG_KV("rcv", _blocks.size())
+                       << LOG_KV("top", m_blocks.topNumber())
                        << LOG_KV("downloadBlockQueue", m_blocks.size())
                        << LOG_KV("nodeId", m_config->nodeID()->shortHex());
-    return true;
 }
 
-bool DownloadingQueue::isNewerBlock(Block::Ptr _block)
+DownloadingQueue::BlockTransactions::Ptr DownloadingQueue::encodeTransactions(Block::Ptr _block)
 {
-    // Note: must holder blockHeader here to ensure the life cycle of blockHeader
+    auto txsSize = _block->transactionsSize();
+    auto blockTransactions = std::make_shared<BlockTransactions>();
+    blockTransactions->txsData = std::make_shared<std::vector<bytesConstPtr>>(txsSize);
+    blockTransactions->txsHash = std::make_shared<HashList>(txsSize);
+    auto& txsData = *(blockTransactions->txsData);
+    auto& txsHash = *(blockTransactions->txsHash);
+    tbb::parallel_for(
+        tbb::blocked_range<size_t>(0, txsSize), [&](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i)
+            {
+                // maintain lifetime for tx
+                auto tx = _block->transaction(i);
+                // Note: the ledger takes an owned buffer for each transaction, and the
+                // transaction only exposes its encoded data by encode, so it is copied once here
+                auto encodedData = tx->encode(false);
+                txsData[i] = std::make_shared<bytes>(encodedData.begin(), encodedData.end());
+                txsHash[i] = tx->hash();
+            }
+        });
+    return blockTransactions;
+}
+
+void DownloadingQueue::clearExpiredTransactions()
+{
+    auto blockNumber = m_config->blockNumber();
+    Guard l(x_storingTransactions);
+    while (!m_storingTransactions.empty() && m_storingTransactions.begin()->first <= blockNumber)
+    {
+        m_storingTransactions.erase(m_storingTransactions.begin());
+    }
+}
+
+DownloadingQueue::TransactionsStoreState::Ptr DownloadingQueue::asyncStoreTransactions(
+    Block::Ptr _block)
+{
+    if (_block->transactionsSize() == 0)
+    {
+        return nullptr;
+    }
     auto blockHeader = _block->blockHeader();
-    if (blockHeader->number() <= m_config->blockNumber())
+    auto blockNumber = blockHeader->number();
+    auto state = std::make_shared<TransactionsStoreState>();
+    state->blockHash = blockHeader->hash();
     {
-        return false;
+        Guard l(x_storingTransactions);
+        auto it = m_storingTransactions.find(blockNumber);
+        // the block is being stored or has been stored successfully
+        if (it != m_storingTransactions.end() && it->second->blockHash == state->blockHash &&
+            (!it->second->finished || !it->second->error))
+        {
+            return it->second;
+        }
+        m_storingTransactions[blockNumber] = state;
     }
-    return true;
+    // the transactions are copied here in parallel with the execution of the previous block
+    // instead of by the decoding stage, which is the bottleneck of catching up
+    auto blockTransactions = encodeTransactions(_block);
+    auto startT = utcTime();
+    auto txsSize = _block->transactionsSize();
+    auto self = std::weak_ptr<DownloadingQueue>(shared_from_this());
+    m_config->ledger()->asyncStoreTransactions(blockTransactions->txsData,
+        blockTransactions->txsHash,
+        [self, state, blockNumber, startT, txsSize](Error::Ptr _error) {
+            try
+            {
+                auto downloadingQueue = self.lock();
+                if (!downloadingQueue)
+                {
+                    return;
+                }
+                std::vector<std::function<void(Error::Ptr)>> onStored;
+                {
+                    Guard l(downloadingQueue->x_storingTransactions);
+                    state->finished = true;
+                    state->error = _error;
+                    onStored.swap(state->onStored);
+                }
+                if (_error)
+                {
+                    BLKSYNC_LOG(WARNING)
+                        << LOG_DESC("asyncStoreTransactions failed")
+                        << LOG_KV("number", blockNumber)
+                        << LOG_KV("hash", state->blockHash.abridged())
+                        << LOG_KV("txsSize", txsSize) << LOG_KV("code", _error->errorCode())
+                        << LOG_KV("msg", _error->errorMessage());
+                }
+                else
+                {
+                    BLKSYNC_LOG(INFO) << LOG_DESC("asyncStoreTransactions success")
+                                      << LOG_KV("number", blockNumber)
+                                      << LOG_KV("hash", state->blockHash.abridged())
+                                      << LOG_KV("txsSize", txsSize)
+                                      << LOG_KV("storeTxsTimeCost", (utcTime() - startT));
+                }
+                for (auto const& callback : onStored)
+                {
+                    callback(_error);
+                }
+            }
+            catch (std::exception const& e)
+            {
+                BLKSYNC_LOG(WARNING) << LOG_DESC("asyncStoreTransactions exception")
+                                     << LOG_KV("number", blockNumber)
+                                     << LOG_KV("error", boost::diagnostic_information(e));
+            }
+        });
+    return state;
 }
 
-void DownloadingQueue::clearFullQueueIfNotHas(BlockNumber _blockNumber)
+void DownloadingQueue::waitTransactionsStored(
+    Block::Ptr _block, std::function<void(Error::Ptr)> _onStored)
 {
-    bool needClear = false;
+    // restart the failed storing
+    auto state = asyncStoreTransactions(_block);
+    Error::Ptr error;
+    if (state)
+    {
+        Guard l(x_storingTransactions);
+        if (!state->finished)
+        {
+            state->onStored.emplace_back(_onStored);
+            return;
+        }
+        error = state->error;
+    }
+    _onStored(error);
+}
+
+void DownloadingQueue::preVerifyBlocks()
+{
+    auto maxPreVerifyBlocks = (BlockNumber)m_config->maxPreVerifyBlocks();
+    if (maxPreVerifyBlocks == 0)
+    {
+        return;
+    }
+    Blocks blocks;
     {
         ReadGuard l(x_blocks);
-        if (m_blocks.size() == m_config->maxDownloadingBlockQueueSize() &&
-            m_blocks.top()->blockHeader()->number() > _blockNumber)
+        auto from = m_config->executedBlock() + 1;
+        for (auto number = from; number < from + maxPreVerifyBlocks; number++)
         {
-            needClear = true;
+            auto block = m_blocks.get(number);
+            if (block)
+            {
+                blocks.emplace_back(block);
+            }
         }
     }
-    if (needClear)
+    // the verified blocks are skipped by the verifier
+    for (auto const& block : blocks)
+    {
+        m_blockVerifier->asyncVerify(block);
+    }
+}
+
+bool DownloadingQueue::isNewerBlock(Block::Ptr _block)
+{
+    // Note: must holder blockHeader here to ensure the life cycle of blockHeader
+    auto blockHeader = _block->blockHeader();
+    if (blockHeader->number() <= m_config->blockNumber())
     {
-        clearQueue();
+        return false;
     }
+    return true;
+}
+
+BlockRanges DownloadingQueue::missingBlocks(BlockNumber _from, BlockNumber _to)
+{
+    WriteGuard l(x_blocks);
+    moveWindow(m_blocks, m_config->nextBlock());
+    return m_blocks.missingRanges(_from, _to);
 }
 
 bool DownloadingQueue::verifyExecutedBlock(
@@ -263,10 +548,16 @@ void DownloadingQueue::applyBlock(Block::Ptr _block)
         m_config->setExecutedBlock(m_config->blockNumber());
         return;
     }
+    // the transactions are stored in parallel with the execution
+    asyncStoreTransactions(_block);
     auto startT = utcTime();
+    auto startUs = steadyTimeUs();
+    m_applyStartTime = startT;
+    m_applyingBlock = true;
     auto self = std::weak_ptr<DownloadingQueue>(shared_from_this());
     m_config->scheduler()->executeBlock(_block, true,
-        [self, startT, _block](Error::Ptr&& _error, protocol::BlockHeader::Ptr&& _blockHeader) {
+        [self, startT, startUs, _block](
+            Error::Ptr&& _error, protocol::BlockHeader::Ptr&& _blockHeader) {
             auto orgBlockHeader = _block->blockHeader();
             try
             {
@@ -287,14 +578,17 @@ void DownloadingQueue::applyBlock(Block::Ptr _block)
                         << LOG_KV("errorCode", _error->errorCode())
                         << LOG_KV("errorMessage", _error->errorMessage());
                     config->setExecutedBlock(config->blockNumber());
+                    downloadQueue->onApplyFinished();
                     return;
                 }
                 if (!downloadQueue->verifyExecutedBlock(_block, _blockHeader))
                 {
                     config->setExecutedBlock(config->blockNumber());
+                    downloadQueue->onApplyFinished();
                     return;
                 }
                 config->setExecutedBlock(orgBlockHeader->number());
+                downloadQueue->m_executionWaterMark->onBlockExecuted(steadyTimeUs() - startUs);
                 auto signature = orgBlockHeader->signatureList();
                 BLKSYNC_LOG(INFO) << LOG_BADGE("Download")
                                   << LOG_DESC("BlockSync: applyBlock success")
@@ -307,6 +601,8 @@ void DownloadingQueue::applyBlock(Block::Ptr _block)
                                   << LOG_KV("node", downloadQueue->m_config->nodeID()->shortHex());
                 // verify and commit the block
                 downloadQueue->updateCommitQueue(_block);
+                // execute the next block without waiting for the commit of this block
+                downloadQueue->onApplyFinished();
             }
             catch (std::exception const& e)
             {
@@ -314,10 +610,38 @@ void DownloadingQueue::applyBlock(Block::Ptr _block)
                                      << LOG_KV("number", orgBlockHeader->number())
                                      << LOG_KV("hash", orgBlockHeader->hash().abridged())
                                      << LOG_KV("error", boost::diagnostic_information(e));
+                // reset the executed number and re-apply the block, in case of the pipeline
+                // stopped until downloadTimeout
+                auto downloadQueue = self.lock();
+                if (!downloadQueue)
+                {
+                    return;
+                }
+                downloadQueue->m_config->setExecutedBlock(downloadQueue->m_config->blockNumber());
+                downloadQueue->onApplyFinished();
             }
         });
 }
 
+void DownloadingQueue::onApplyFinished()
+{
+    m_applyingBlock = false;
+    if (m_applyFinishedHandler)
+    {
+        m_applyFinishedHandler();
+    }
+}
+
+bool DownloadingQueue::isApplyingBlock() const
+{
+    if (!m_applyingBlock)
+    {
+        return false;
+    }
+    // the scheduler may never respond, allow to re-apply the block after downloadTimeout
+    return (utcTime() - m_applyStartTime) < m_config->downloadTimeout();
+}
+
 bool DownloadingQueue::checkAndCommitBlock(bcos::protocol::Block::Ptr _block)
 {
     auto blockHeader = _block->blockHeader();
@@ -333,7 +657,8 @@ bool DownloadingQueue::checkAndCommitBlock(bcos::protocol::Block::Ptr _block)
         return false;
     }
     auto self = std::weak_ptr<DownloadingQueue>(shared_from_this());
-    m_config->consensus()->asyncCheckBlock(
+    // the block may have been verified ahead of the execution
+    m_blockVerifier->asyncCheckBlock(
         _block, [self, _block, blockHeader](Error::Ptr _error, bool _ret) {
             try
             {
@@ -377,7 +702,8 @@ void DownloadingQueue::updateCommitQueue(Block::Ptr _block)
 {
     {
         WriteGuard l(x_commitQueue);
-        m_commitQueue.push(_block);
+        moveWindow(m_commitQueue, m_config->nextBlock());
+        m_commitQueue.insert(_block);
     }
     tryToCommitBlockToLedger();
 }
@@ -390,17 +716,13 @@ void DownloadingQueue::tryToCommitBlockToLedger()
         return;
     }
     // remove expired block
-    while (!m_commitQueue.empty() &&
-           m_commitQueue.top()->blockHeader()->number() <= m_config->blockNumber())
-    {
-        m_commitQueue.pop();
-    }
+    auto nextBlock = m_config->nextBlock();
+    moveWindow(m_commitQueue, nextBlock);
     // try to commit the block
-    if (!m_commitQueue.empty() &&
-        m_commitQueue.top()->blockHeader()->number() == m_config->nextBlock())
+    auto block = m_commitQueue.get(nextBlock);
+    if (block)
     {
-        auto block = m_commitQueue.top();
-        m_commitQueue.pop();
+        m_commitQueue.erase(nextBlock);
         checkAndCommitBlock(block);
     }
 }
@@ -416,59 +738,46 @@ void DownloadingQueue::commitBlock(bcos::protocol::Block::Ptr _block)
     if (_block->transactionsSize() == 0)
     {
         commitBlockState(_block);
+        return;
     }
-    // commit transaction firstly
-    auto txsData = std::make_shared<std::vector<bytesConstPtr>>();
-    auto txsSize = _block->transactionsSize();
-    auto txsHashList = std::make_shared<HashList>();
-
-    txsData->resize(txsSize);
-    txsHashList->resize(txsSize);
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, txsSize), [&](const tbb::blocked_range<size_t>& range) {
-            for (size_t i = range.begin(); i < range.end(); ++i)
-            {
-                // maintain lifetime for tx
-                auto tx = _block->transaction(i);
-                auto encodedData = tx->encode(false);
-                (*txsData)[i] = std::make_shared<bytes>(encodedData.begin(), encodedData.end());
-                (*txsHashList)[i] = tx->hash();
-            }
-        });
+    // wait for the transactions stored in parallel with the execution
     auto startT = utcTime();
+    auto startUs = steadyTimeUs();
     auto self = std::weak_ptr<DownloadingQueue>(shared_from_this());
-    m_config->ledger()->asyncStoreTransactions(
-        txsData, txsHashList, [self, startT, _block, blockHeader](Error::Ptr _error) {
-            try
+    waitTransactionsStored(_block, [self, startT, startUs, _block, blockHeader](
+                                       Error::Ptr _error) {
+        try
+        {
+            auto downloadingQueue = self.lock();
+            if (!downloadingQueue)
             {
-                auto downloadingQueue = self.lock();
-                if (!downloadingQueue)
-                {
-                    return;
-                }
-                // store transaction failed
-                if (_error)
-                {
-                    downloadingQueue->m_config->setExecutedBlock(blockHeader->number() - 1);
-                    BLKSYNC_LOG(WARNING) << LOG_DESC("commitBlock: store transactions failed")
-                                         << LOG_KV("number", blockHeader->number())
-                                         << LOG_KV("hash", blockHeader->hash().abridged())
-                                         << LOG_KV("txsSize", _block->transactionsSize());
-                    return;
-                }
-                BLKSYNC_LOG(INFO) << LOG_DESC("commitBlock: store transactions success")
-                                  << LOG_KV("number", blockHeader->number())
-                                  << LOG_KV("hash", blockHeader->hash().abridged())
-                                  << LOG_KV("txsSize", _block->transactionsSize())
-                                  << LOG_KV("storeTxsTimeCost", (utcTime() - startT));
-                downloadingQueue->commitBlockState(_block);
+                return;
             }
-            catch (std::exception const& e)
+            // store transaction failed
+            if (_error)
             {
-                BLKSYNC_LOG(WARNING) << LOG_DESC("commitBlock exception")
-                                     << LOG_KV("error", boost::diagnostic_information(e));
+                downloadingQueue->m_config->setExecutedBlock(blockHeader->number() - 1);
+                BLKSYNC_LOG(WARNING) << LOG_DESC("commitBlock: store transactions failed")
+                                     << LOG_KV("number", blockHeader->number())
+                                     << LOG_KV("hash", blockHeader->hash().abridged())
+                                     << LOG_KV("txsSize", _block->transactionsSize());
+                return;
             }
-        });
+            BLKSYNC_LOG(INFO) << LOG_DESC("commitBlock: store transactions success")
+                              << LOG_KV("number", blockHeader->number())
+                              << LOG_KV("hash", blockHeader->hash().abridged())
+                              << LOG_KV("txsSize", _block->transactionsSize())
+                              << LOG_KV("waitStoreTxsTimeCost", (utcTime() - startT));
+            // only the time waiting for the storing delays the commit
+            downloadingQueue->m_executionWaterMark->onTransactionsStored(steadyTimeUs() - startUs);
+            downloadingQueue->commitBlockState(_block);
+        }
+        catch (std::exception const& e)
+        {
+            BLKSYNC_LOG(WARNING) << LOG_DESC("commitBlock exception")
+                                 << LOG_KV("error", boost::diagnostic_information(e));
+        }
+    });
 }
 
 void DownloadingQueue::commitBlockState(bcos::protocol::Block::Ptr _block)
@@ -477,8 +786,9 @@ void DownloadingQueue::commitBlockState(bcos::protocol::Block::Ptr _block)
     BLKSYNC_LOG(INFO) << LOG_DESC("commitBlockState") << LOG_KV("number", blockHeader->number())
                       << LOG_KV("hash", blockHeader->hash().abridged());
     auto startT = utcTime();
+    auto startUs = steadyTimeUs();
     auto self = std::weak_ptr<DownloadingQueue>(shared_from_this());
-    m_config->scheduler()->commitBlock(blockHeader, [self, startT, _block, blockHeader](
+    m_config->scheduler()->commitBlock(blockHeader, [self, startT, startUs, _block, blockHeader](
                                                         Error::Ptr&& _error,
                                                         LedgerConfig::Ptr&& _ledgerConfig) {
         try
@@ -498,6 +808,7 @@ void DownloadingQueue::commitBlockState(bcos::protocol::Block::Ptr _block)
                                      << LOG_KV("message", _error->errorMessage());
                 return;
             }
+            downloadingQueue->m_executionWaterMark->onBlockCommitted(steadyTimeUs() - startUs);
             _ledgerConfig->setTxsSize(_block->transactionsSize());
             _ledgerConfig->setSealerId(blockHeader->sealer());
             // notify the txpool the transaction result
@@ -522,12 +833,17 @@ void DownloadingQueue::commitBlockState(bcos::protocol::Block::Ptr _block)
 }
 
 
-void DownloadingQueue::finalizeBlock(bcos::protocol::Block::Ptr, LedgerConfig::Ptr _ledgerConfig)
+void DownloadingQueue::finalizeBlock(
+    bcos::protocol::Block::Ptr _block, LedgerConfig::Ptr _ledgerConfig)
 {
     if (m_newBlockHandler)
     {
         m_newBlockHandler(_ledgerConfig);
     }
+    if (m_blockCommittedHandler)
+    {
+        m_blockCommittedHandler(_block);
+    }
     // try to commit the next block
     tryToCommitBlockToLedger();
 }
@@ -536,13 +852,12 @@ void DownloadingQueue::clearExpiredQueueCache()
 {
     clearExpiredCache(m_blocks, x_blocks);
     clearExpiredCache(m_commitQueue, x_commitQueue);
+    clearExpiredTransactions();
+    m_blockVerifier->clearExpired(m_config->blockNumber());
 }
 
-void DownloadingQueue::clearExpiredCache(BlockQueue& _queue, SharedMutex& _lock)
+void DownloadingQueue::clearExpiredCache(BlockWindow& _queue, SharedMutex& _lock)
 {
     WriteGuard l(_lock);
-    while (!_queue.empty() && _queue.top()->blockHeader()->number() <= m_config->blockNumber())
-    {
-        _queue.pop();
-    }
+    moveWindow(_queue, m_config->nextBlock());
 }
\ No newline at end of file
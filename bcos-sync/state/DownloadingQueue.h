@@ -21,37 +21,57 @@
 #pragma once
 #include "bcos-sync/BlockSyncConfig.h"
 #include "bcos-sync/interfaces/BlocksMsgInterface.h"
+#include "bcos-sync/state/BlockVerifier.h"
+#include "bcos-sync/state/BlockWindow.h"
+#include "bcos-sync/state/ExecutionWaterMark.h"
 #include <bcos-framework/interfaces/protocol/Block.h>
-#include <queue>
 namespace bcos
 {
 namespace sync
 {
-// increase order
-struct BlockCmp
-{
-    bool operator()(
-        bcos::protocol::Block::Ptr const& _first, bcos::protocol::Block::Ptr const& _second) const
-    {
-        // increase order
-        return _first->blockHeader()->number() > _second->blockHeader()->number();
-    }
-};
-using BlockQueue =
-    std::priority_queue<bcos::protocol::Block::Ptr, bcos::protocol::Blocks, BlockCmp>;
 class DownloadingQueue : public std::enable_shared_from_this<DownloadingQueue>
 {
 public:
-    using BlocksMessageQueue = std::list<BlocksMsgInterface::Ptr>;
+    // the received BlocksMsg and the peer sent it
+    using BlocksShard = std::pair<BlocksMsgInterface::Ptr, bcos::crypto::NodeIDPtr>;
+    using BlocksMessageQueue = std::list<BlocksShard>;
     using BlocksMessageQueuePtr = std::shared_ptr<BlocksMessageQueue>;
 
+    // the encoded transactions and their hashes of a downloaded block to be stored
+    struct BlockTransactions
+    {
+        using Ptr = std::shared_ptr<BlockTransactions>;
+        std::shared_ptr<std::vector<bytesConstPtr>> txsData;
+        bcos::crypto::HashListPtr txsHash;
+    };
+
+    // the transactions of the block being stored or stored, the callbacks wait for the result
+    struct TransactionsStoreState
+    {
+        using Ptr = std::shared_ptr<TransactionsStoreState>;
+        bcos::crypto::HashType blockHash;
+        bool finished = false;
+        Error::Ptr error;
+        std::vector<std::function<void(Error::Ptr)>> onStored;
+    };
+
     using Ptr = std::shared_ptr<DownloadingQueue>;
     explicit DownloadingQueue(BlockSyncConfig::Ptr _config)
-      : m_config(_config), m_blockBuffer(std::make_shared<BlocksMessageQueue>())
+      : m_config(_config),
+        m_blocks(_config->maxDownloadingBlockQueueSize()),
+        m_blockBuffer(std::make_shared<BlocksMessageQueue>()),
+        m_commitQueue(_config->maxDownloadingBlockQueueSize()),
+        m_executionWaterMark(std::make_shared<ExecutionWaterMark>(_config)),
+        m_blockVerifier(std::make_shared<BlockVerifier>(_config))
     {}
     virtual ~DownloadingQueue() {}
 
-    virtual void push(BlocksMsgInterface::Ptr _blocksData);
+    virtual void push(
+        BlocksMsgInterface::Ptr _blocksData, bcos::crypto::NodeIDPtr _peer = nullptr);
+    // push the block decoded outside the queue, e.g. the filled compact block,
+    // _blockSize is the estimated memory size of the block
+    virtual void push(
+        bcos::protocol::Block::Ptr _block, size_t _blockSize, bcos::crypto::NodeIDPtr _peer);
     // Is the queue empty?
     virtual bool empty();
 
@@ -64,7 +84,9 @@ public:
     // get the top unit of the block queue
     bcos::protocol::Block::Ptr top(bool isFlushBuffer = false);
 
-    virtual void clearFullQueueIfNotHas(bcos::protocol::BlockNumber _blockNumber);
+    // the ranges of the numbers in [_from, _to] that have not been downloaded
+    virtual BlockRanges missingBlocks(
+        bcos::protocol::BlockNumber _from, bcos::protocol::BlockNumber _to);
 
     virtual void applyBlock(bcos::protocol::Block::Ptr _block);
     // clear queue and buffer
@@ -76,6 +98,34 @@ public:
         m_newBlockHandler = _newBlockHandler;
     }
 
+    // called when the downloaded block has been committed to the ledger
+    virtual void registerBlockCommittedHandler(
+        std::function<void(bcos::protocol::Block::Ptr)> _blockCommittedHandler)
+    {
+        m_blockCommittedHandler = _blockCommittedHandler;
+    }
+
+    // check the decoded block received from the peer, the block is dropped if returns false
+    virtual void registerBlockChecker(
+        std::function<bool(bcos::crypto::NodeIDPtr, bcos::protocol::Block::Ptr)> _blockChecker)
+    {
+        m_blockChecker = _blockChecker;
+    }
+
+    // called when the scheduler finished executing a block, to trigger the next block execution
+    virtual void registerApplyFinishedHandler(std::function<void()> _applyFinishedHandler)
+    {
+        m_applyFinishedHandler = _applyFinishedHandler;
+    }
+
+    ExecutionWaterMark::Ptr executionWaterMark() { return m_executionWaterMark; }
+    BlockVerifier::Ptr blockVerifier() { return m_blockVerifier; }
+    // verify the downloaded blocks following the executed block in parallel
+    virtual void preVerifyBlocks();
+
+    // the block is being executed by the scheduler
+    virtual bool isApplyingBlock() const;
+
     // flush m_buffer into queue
     virtual void flushBufferToQueue();
     virtual void clearExpiredQueueCache();
@@ -89,8 +139,22 @@ public:
 protected:
     // clear queue
     virtual void clearQueue();
-    virtual void clearExpiredCache(BlockQueue& _queue, SharedMutex& _lock);
-    virtual bool flushOneShard(BlocksMsgInterface::Ptr _blocksData);
+    virtual void clearExpiredCache(BlockWindow& _queue, SharedMutex& _lock);
+    // fetch all the buffered shards if the block queue is not full
+    virtual BlocksMessageQueuePtr fetchBufferedShards();
+    // decode the blocks of the given shards in parallel without holding any lock
+    virtual bcos::protocol::Blocks decodeShards(BlocksMessageQueuePtr _blocksShards);
+    virtual void flushBlocksToQueue(bcos::protocol::Blocks const& _blocks);
+    // collect the encoded transactions and the hashes of the decoded block
+    virtual BlockTransactions::Ptr encodeTransactions(bcos::protocol::Block::Ptr _block);
+    virtual void clearExpiredTransactions();
+    // start storing the transactions of the block to be executed, a block is stored only once
+    // unless failed, return the state of the storing, nullptr for the empty block
+    virtual TransactionsStoreState::Ptr asyncStoreTransactions(bcos::protocol::Block::Ptr _block);
+    // _onStored is called once the transactions of the block have been stored, the storing is
+    // started if it has not been or failed
+    virtual void waitTransactionsStored(
+        bcos::protocol::Block::Ptr _block, std::function<void(Error::Ptr)> _onStored);
     virtual bool isNewerBlock(bcos::protocol::Block::Ptr _block);
 
     virtual void commitBlock(bcos::protocol::Block::Ptr _block);
@@ -103,23 +167,40 @@ protected:
         bcos::protocol::Block::Ptr _block, bcos::ledger::LedgerConfig::Ptr _ledgerConfig);
     virtual bool verifyExecutedBlock(
         bcos::protocol::Block::Ptr _block, bcos::protocol::BlockHeader::Ptr _blockHeader);
+    virtual void onApplyFinished();
 
 private:
+    // resize the window to maxDownloadingBlockQueueSize and move it to start from _nextBlock,
+    // the caller should hold the lock of the window
+    void moveWindow(BlockWindow& _window, bcos::protocol::BlockNumber _nextBlock);
     // Note: this function should not be called frequently
     std::string printBlockHeader(bcos::protocol::BlockHeader::Ptr _header);
 
 private:
     BlockSyncConfig::Ptr m_config;
-    BlockQueue m_blocks;
+    BlockWindow m_blocks;
     mutable SharedMutex x_blocks;
 
     BlocksMessageQueuePtr m_blockBuffer;
     mutable SharedMutex x_blockBuffer;
 
-    BlockQueue m_commitQueue;
+    // block number => the transactions being stored in parallel with the execution
+    std::map<bcos::protocol::BlockNumber, TransactionsStoreState::Ptr> m_storingTransactions;
+    mutable Mutex x_storingTransactions;
+
+    BlockWindow m_commitQueue;
     mutable SharedMutex x_commitQueue;
 
     std::function<void(bcos::ledger::LedgerConfig::Ptr)> m_newBlockHandler;
+    std::function<void()> m_applyFinishedHandler;
+    std::function<void(bcos::protocol::Block::Ptr)> m_blockCommittedHandler;
+    std::function<bool(bcos::crypto::NodeIDPtr, bcos::protocol::Block::Ptr)> m_blockChecker;
+    ExecutionWaterMark::Ptr m_executionWaterMark;
+    BlockVerifier::Ptr m_blockVerifier;
+
+    // only one block is executed at a time, the others are pipelined behind it
+    std::atomic_bool m_applyingBlock = {false};
+    std::atomic<uint64_t> m_applyStartTime = {0};
 };
 }  // namespace sync
 }  // namespace bcos
\ No newline at end of file
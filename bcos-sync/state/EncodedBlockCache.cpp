@@ -0,0 +1,122 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief cache the encoded data of the recently committed blocks
+ * @file EncodedBlockCache.cpp
+ * @author: yujiechen
+ * @date 2021-06-19
+ */
+#include "EncodedBlockCache.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+using namespace bcos::crypto;
+
+bytesConstPtr EncodedBlockCache::get(BlockNumber _number) const
+{
+    ReadGuard l(x_blocks);
+    auto it = m_blocks.find(_number);
+    if (it == m_blocks.end())
+    {
+        m_misses++;
+        return nullptr;
+    }
+    m_hits++;
+    return it->second.data;
+}
+
+void EncodedBlockCache::insert(
+    BlockNumber _number, HashType const& _hash, bytesConstPtr _blockData)
+{
+    if (!_blockData || _blockData->size() > m_capacity)
+    {
+        return;
+    }
+    WriteGuard l(x_blocks);
+    auto it = m_blocks.find(_number);
+    if (it != m_blocks.end())
+    {
+        if (it->second.hash == _hash)
+        {
+            return;
+        }
+        BLKSYNC_LOG(WARNING) << LOG_BADGE("EncodedBlockCache")
+                             << LOG_DESC("Drop the cached blocks for hash mismatch")
+                             << LOG_KV("number", _number)
+                             << LOG_KV("cachedHash", it->second.hash.abridged())
+                             << LOG_KV("hash", _hash.abridged());
+        eraseFrom(_number);
+    }
+    // the block is older than all the cached blocks and there is no space for it
+    if (!m_blocks.empty() && _number < m_blocks.begin()->first &&
+        m_size + _blockData->size() > m_capacity)
+    {
+        return;
+    }
+    m_blocks[_number] = CachedBlock{_hash, _blockData};
+    m_size += _blockData->size();
+    // evict the oldest blocks
+    while (m_size > m_capacity && !m_blocks.empty())
+    {
+        m_size -= m_blocks.begin()->second.data->size();
+        m_blocks.erase(m_blocks.begin());
+    }
+}
+
+void EncodedBlockCache::onNewBlock(BlockNumber _number, HashType const& _hash)
+{
+    WriteGuard l(x_blocks);
+    if (m_blocks.empty())
+    {
+        return;
+    }
+    auto it = m_blocks.find(_number);
+    if (it != m_blocks.end() && it->second.hash != _hash)
+    {
+        eraseFrom(_number);
+        return;
+    }
+    eraseFrom(_number + 1);
+}
+
+void EncodedBlockCache::eraseFrom(BlockNumber _number)
+{
+    auto it = m_blocks.lower_bound(_number);
+    while (it != m_blocks.end())
+    {
+        m_size -= it->second.data->size();
+        it = m_blocks.erase(it);
+    }
+}
+
+void EncodedBlockCache::clear()
+{
+    WriteGuard l(x_blocks);
+    m_blocks.clear();
+    m_size = 0;
+}
+
+size_t EncodedBlockCache::size() const
+{
+    ReadGuard l(x_blocks);
+    return m_size;
+}
+
+size_t EncodedBlockCache::blocks() const
+{
+    ReadGuard l(x_blocks);
+    return m_blocks.size();
+}
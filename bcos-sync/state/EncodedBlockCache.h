@@ -0,0 +1,74 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief cache the encoded data of the recently committed blocks
+ * @file EncodedBlockCache.h
+ * @author: yujiechen
+ * @date 2021-06-19
+ */
+#pragma once
+#include "bcos-sync/utilities/Common.h"
+#include <bcos-framework/interfaces/protocol/Block.h>
+namespace bcos
+{
+namespace sync
+{
+// the committed blocks keyed by the block number, the older blocks are evicted first once the
+// encoded data exceeds the capacity
+class EncodedBlockCache
+{
+public:
+    using Ptr = std::shared_ptr<EncodedBlockCache>;
+    explicit EncodedBlockCache(size_t _capacity) : m_capacity(_capacity) {}
+    virtual ~EncodedBlockCache() {}
+
+    // return nullptr if the block is not cached
+    virtual bytesConstPtr get(bcos::protocol::BlockNumber _number) const;
+    // the stored blocks with the same number but different hash are dropped, as well as the
+    // blocks after them
+    virtual void insert(bcos::protocol::BlockNumber _number, bcos::crypto::HashType const& _hash,
+        bytesConstPtr _blockData);
+    // the block _number with _hash has been committed, drop the mismatched and newer blocks
+    virtual void onNewBlock(
+        bcos::protocol::BlockNumber _number, bcos::crypto::HashType const& _hash);
+    virtual void clear();
+
+    // the total size of the cached data
+    size_t size() const;
+    size_t blocks() const;
+    size_t capacity() const { return m_capacity; }
+    uint64_t hits() const { return m_hits; }
+    uint64_t misses() const { return m_misses; }
+
+protected:
+    // remove the blocks not smaller than _number, the caller should hold the write lock
+    void eraseFrom(bcos::protocol::BlockNumber _number);
+
+private:
+    struct CachedBlock
+    {
+        bcos::crypto::HashType hash;
+        bytesConstPtr data;
+    };
+    std::map<bcos::protocol::BlockNumber, CachedBlock> m_blocks;
+    size_t m_size = 0;
+    size_t m_capacity;
+    mutable SharedMutex x_blocks;
+
+    mutable std::atomic<uint64_t> m_hits = {0};
+    mutable std::atomic<uint64_t> m_misses = {0};
+};
+}  // namespace sync
+}  // namespace bcos
@@ -0,0 +1,101 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief adaptive water mark that limits how far the executed block runs ahead of the ledger
+ * @file ExecutionWaterMark.cpp
+ * @author: yujiechen
+ * @date 2021-06-15
+ */
+#include "ExecutionWaterMark.h"
+#include "bcos-sync/utilities/Common.h"
+#include <cmath>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+
+double ExecutionWaterMark::updateAverage(double _average, double _value, bool& _measured)
+{
+    // the first sample
+    if (!_measured)
+    {
+        _measured = true;
+        return _value;
+    }
+    return (1 - c_sampleWeight) * _average + c_sampleWeight * _value;
+}
+
+void ExecutionWaterMark::onBlockDecoded(size_t _blockDataSize)
+{
+    Guard l(m_mutex);
+    m_blockDataSize = updateAverage(m_blockDataSize, _blockDataSize, m_blockDataSizeMeasured);
+}
+
+void ExecutionWaterMark::onBlockExecuted(uint64_t _timeCost)
+{
+    {
+        Guard l(m_mutex);
+        m_executeCost = updateAverage(m_executeCost, _timeCost, m_executeMeasured);
+    }
+    updateWaterMark();
+}
+
+void ExecutionWaterMark::onTransactionsStored(uint64_t _timeCost)
+{
+    Guard l(m_mutex);
+    m_storeTxsCost = updateAverage(m_storeTxsCost, _timeCost, m_storeTxsMeasured);
+}
+
+void ExecutionWaterMark::onBlockCommitted(uint64_t _timeCost)
+{
+    {
+        Guard l(m_mutex);
+        m_commitCost = updateAverage(m_commitCost, _timeCost, m_commitMeasured);
+    }
+    updateWaterMark();
+}
+
+void ExecutionWaterMark::updateWaterMark()
+{
+    double waterMark = 0;
+    {
+        Guard l(m_mutex);
+        // no enough samples
+        if (!m_executeMeasured || !m_commitMeasured)
+        {
+            return;
+        }
+        // the number of blocks that can be executed while committing one block, one more block
+        // to keep the scheduler busy
+        waterMark = std::ceil((m_storeTxsCost + m_commitCost) / std::max(m_executeCost, 1.0)) + 1;
+        // the executed blocks must fit into the memory budget
+        auto memoryBudget = m_config->executionMemoryBudget();
+        if (memoryBudget > 0 && m_blockDataSizeMeasured && m_blockDataSize > 0)
+        {
+            waterMark = std::min(waterMark, std::floor(memoryBudget / m_blockDataSize));
+        }
+    }
+    auto newWaterMark = std::max((BlockNumber)waterMark, m_config->minExecutionWaterMark());
+    newWaterMark = std::min(newWaterMark, m_config->maxExecutionWaterMark());
+    auto orgWaterMark = m_waterMark.exchange(newWaterMark);
+    if (orgWaterMark == newWaterMark)
+    {
+        return;
+    }
+    BLKSYNC_LOG(DEBUG) << LOG_DESC("ExecutionWaterMark: update waterMark")
+                       << LOG_KV("orgWaterMark", orgWaterMark)
+                       << LOG_KV("waterMark", newWaterMark)
+                       << LOG_KV("memoryBudget", m_config->executionMemoryBudget());
+}
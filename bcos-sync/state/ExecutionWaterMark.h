@@ -0,0 +1,67 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief adaptive water mark that limits how far the executed block runs ahead of the ledger
+ * @file ExecutionWaterMark.h
+ * @author: yujiechen
+ * @date 2021-06-15
+ */
+#pragma once
+#include "bcos-sync/BlockSyncConfig.h"
+namespace bcos
+{
+namespace sync
+{
+class ExecutionWaterMark
+{
+public:
+    using Ptr = std::shared_ptr<ExecutionWaterMark>;
+    explicit ExecutionWaterMark(BlockSyncConfig::Ptr _config) : m_config(_config) {}
+    virtual ~ExecutionWaterMark() {}
+
+    // the max number of blocks that can be executed but not committed
+    virtual bcos::protocol::BlockNumber waterMark() const { return m_waterMark; }
+
+    // update the measured cost of every stage, the timeCost is in microseconds
+    virtual void onBlockDecoded(size_t _blockDataSize);
+    virtual void onBlockExecuted(uint64_t _timeCost);
+    virtual void onTransactionsStored(uint64_t _timeCost);
+    virtual void onBlockCommitted(uint64_t _timeCost);
+
+protected:
+    virtual void updateWaterMark();
+    double updateAverage(double _average, double _value, bool& _measured);
+
+private:
+    BlockSyncConfig::Ptr m_config;
+    std::atomic<bcos::protocol::BlockNumber> m_waterMark = {10};
+
+    // the moving average of the measured costs
+    double m_executeCost = 0;
+    double m_storeTxsCost = 0;
+    double m_commitCost = 0;
+    double m_blockDataSize = 0;
+    // the costs of less than a microsecond are measured as 0, so the samples are tracked apart
+    bool m_executeMeasured = false;
+    bool m_storeTxsMeasured = false;
+    bool m_commitMeasured = false;
+    bool m_blockDataSizeMeasured = false;
+    mutable Mutex m_mutex;
+
+    // the weight of the latest sample
+    double const c_sampleWeight = 0.2;
+};
+}  // namespace sync
+}  // namespace bcos
@@ -0,0 +1,234 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief the verified block headers downloaded by the header-first sync
+ * @file HeaderChain.cpp
+ * @author: yujiechen
+ * @date 2021-06-21
+ */
+#include "HeaderChain.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+using namespace bcos::crypto;
+
+void HeaderChain::reset(BlockNumber _number, HashType const& _hash)
+{
+    Guard l(m_mutex);
+    m_baseNumber = _number;
+    m_baseHash = _hash;
+    m_headers.clear();
+    m_pendingSegments.clear();
+}
+
+void HeaderChain::onNewBlock(BlockNumber _number, HashType const& _hash)
+{
+    Guard l(m_mutex);
+    if (_number <= m_baseNumber)
+    {
+        return;
+    }
+    auto verifiedNumber = m_baseNumber + (BlockNumber)m_headers.size();
+    if (_number > verifiedNumber || m_headers[_number - m_baseNumber - 1]->hash() != _hash)
+    {
+        if (_number <= verifiedNumber)
+        {
+            BLKSYNC_LOG(WARNING) << LOG_BADGE("HeaderChain")
+                                 << LOG_DESC("The committed block conflicts with the header chain")
+                                 << LOG_KV("number", _number) << LOG_KV("hash", _hash.abridged());
+        }
+        // the chain is restarted from the committed block
+        m_baseNumber = _number;
+        m_baseHash = _hash;
+        m_headers.clear();
+        m_pendingSegments.clear();
+        return;
+    }
+    while (m_baseNumber < _number)
+    {
+        m_headers.pop_front();
+        m_baseNumber++;
+    }
+    m_baseHash = _hash;
+}
+
+bool HeaderChain::isChild(
+    BlockHeader::Ptr _header, BlockNumber _parentNumber, HashType const& _parentHash)
+{
+    if (_header->number() != _parentNumber + 1)
+    {
+        return false;
+    }
+    auto parentInfo = _header->parentInfo();
+    for (auto const& parent : parentInfo)
+    {
+        if (parent.blockNumber == _parentNumber && parent.blockHash == _parentHash)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HeaderChain::insert(NodeIDPtr _peer, std::vector<BlockHeader::Ptr> _headers)
+{
+    if (_headers.empty())
+    {
+        return true;
+    }
+    for (size_t i = 1; i < _headers.size(); i++)
+    {
+        auto const& parent = _headers[i - 1];
+        if (!isChild(_headers[i], parent->number(), parent->hash()))
+        {
+            BLKSYNC_LOG(WARNING) << LOG_BADGE("HeaderChain")
+                                 << LOG_DESC("Receive the headers not linked with each other")
+                                 << LOG_KV("number", _headers[i]->number())
+                                 << LOG_KV("parent", parent->number())
+                                 << LOG_KV("peer", _peer->shortHex());
+            return false;
+        }
+    }
+    auto firstNumber = _headers.front()->number();
+    Guard l(m_mutex);
+    if (_headers.back()->number() <= m_baseNumber + (BlockNumber)m_headers.size())
+    {
+        return true;
+    }
+    auto it = m_pendingSegments.find(firstNumber);
+    if (it != m_pendingSegments.end() && it->second.headers.size() >= _headers.size())
+    {
+        return true;
+    }
+    m_pendingSegments[firstNumber] = HeaderSegment{_peer, std::move(_headers)};
+    return true;
+}
+
+NodeIDs HeaderChain::connect()
+{
+    NodeIDs conflictPeers;
+    Guard l(m_mutex);
+    auto verifiedNumber = m_baseNumber + (BlockNumber)m_headers.size();
+    auto verifiedHash = m_headers.empty() ? m_baseHash : m_headers.back()->hash();
+    // the segments are ordered by the first number, and the verified number only grows
+    auto it = m_pendingSegments.begin();
+    while (it != m_pendingSegments.end() && it->first <= verifiedNumber + 1)
+    {
+        auto segment = std::move(it->second);
+        it = m_pendingSegments.erase(it);
+        bool conflict = false;
+        for (auto const& header : segment.headers)
+        {
+            auto number = header->number();
+            if (number <= m_baseNumber)
+            {
+                continue;
+            }
+            // the verified header should be the same
+            if (number <= verifiedNumber)
+            {
+                if (m_headers[number - m_baseNumber - 1]->hash() != header->hash())
+                {
+                    conflict = true;
+                    break;
+                }
+                continue;
+            }
+            if (!isChild(header, verifiedNumber, verifiedHash))
+            {
+                conflict = true;
+                break;
+            }
+            m_headers.emplace_back(header);
+            verifiedNumber = number;
+            verifiedHash = header->hash();
+        }
+        if (conflict)
+        {
+            BLKSYNC_LOG(WARNING) << LOG_BADGE("HeaderChain")
+                                 << LOG_DESC("Receive the headers conflict with the header chain")
+                                 << LOG_KV("from", segment.headers.front()->number())
+                                 << LOG_KV("to", segment.headers.back()->number())
+                                 << LOG_KV("verifiedNumber", verifiedNumber)
+                                 << LOG_KV("peer", segment.peer->shortHex());
+            conflictPeers.emplace_back(segment.peer);
+        }
+    }
+    return conflictPeers;
+}
+
+BlockNumber HeaderChain::number() const
+{
+    Guard l(m_mutex);
+    return m_baseNumber + (BlockNumber)m_headers.size();
+}
+
+BlockHeader::Ptr HeaderChain::header(BlockNumber _number) const
+{
+    Guard l(m_mutex);
+    if (_number <= m_baseNumber || _number > m_baseNumber + (BlockNumber)m_headers.size())
+    {
+        return nullptr;
+    }
+    return m_headers[_number - m_baseNumber - 1];
+}
+
+bool HeaderChain::matches(Block::Ptr _block) const
+{
+    auto blockHeader = _block->blockHeader();
+    auto verifiedHeader = header(blockHeader->number());
+    if (!verifiedHeader)
+    {
+        return true;
+    }
+    return verifiedHeader->hash() == blockHeader->hash();
+}
+
+BlockRanges HeaderChain::missingRanges(BlockNumber _from, BlockNumber _to) const
+{
+    BlockRanges missingRanges;
+    Guard l(m_mutex);
+    auto next = std::max(_from, m_baseNumber + (BlockNumber)m_headers.size() + 1);
+    for (auto const& it : m_pendingSegments)
+    {
+        auto segmentFrom = it.first;
+        auto segmentTo = it.second.headers.back()->number();
+        if (segmentTo < next)
+        {
+            continue;
+        }
+        if (segmentFrom > _to)
+        {
+            break;
+        }
+        if (segmentFrom > next)
+        {
+            missingRanges.emplace_back(next, segmentFrom - 1);
+        }
+        next = segmentTo + 1;
+    }
+    if (next <= _to)
+    {
+        missingRanges.emplace_back(next, _to);
+    }
+    return missingRanges;
+}
+
+size_t HeaderChain::size() const
+{
+    Guard l(m_mutex);
+    return m_headers.size();
+}
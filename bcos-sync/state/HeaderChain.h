@@ -0,0 +1,88 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief the verified block headers downloaded by the header-first sync
+ * @file HeaderChain.h
+ * @author: yujiechen
+ * @date 2021-06-21
+ */
+#pragma once
+#include "bcos-sync/state/BlockWindow.h"
+#include "bcos-sync/utilities/Common.h"
+#include <bcos-framework/interfaces/protocol/Block.h>
+#include <deque>
+namespace bcos
+{
+namespace sync
+{
+// the headers are linked by the parent hash from the latest block of the ledger, the segments
+// received out of order are kept pending until they can be linked to the verified headers,
+// the signature list of the segment tip should be checked by the consensus before inserted
+class HeaderChain
+{
+public:
+    using Ptr = std::shared_ptr<HeaderChain>;
+    HeaderChain() = default;
+    virtual ~HeaderChain() {}
+
+    // restart the chain from the given block, all the headers are dropped
+    virtual void reset(bcos::protocol::BlockNumber _number, bcos::crypto::HashType const& _hash);
+    // the block _number with _hash has been committed, drop the headers not newer than it, and
+    // restart the chain if the committed block conflicts with the verified headers
+    virtual void onNewBlock(
+        bcos::protocol::BlockNumber _number, bcos::crypto::HashType const& _hash);
+
+    // insert the consecutive headers received from _peer, return false if the headers are not
+    // consecutive or not linked with each other
+    virtual bool insert(
+        bcos::crypto::NodeIDPtr _peer, std::vector<bcos::protocol::BlockHeader::Ptr> _headers);
+    // link the pending segments to the verified headers, return the peers sent the segments
+    // conflicting with the verified headers
+    virtual bcos::crypto::NodeIDs connect();
+
+    // the number of the newest verified header
+    virtual bcos::protocol::BlockNumber number() const;
+    // the verified header of the given number, nullptr if not verified
+    virtual bcos::protocol::BlockHeader::Ptr header(bcos::protocol::BlockNumber _number) const;
+    // false if the header of the block conflicts with the verified header
+    virtual bool matches(bcos::protocol::Block::Ptr _block) const;
+    // the numbers in [_from, _to] that are neither verified nor pending
+    virtual BlockRanges missingRanges(
+        bcos::protocol::BlockNumber _from, bcos::protocol::BlockNumber _to) const;
+
+    virtual size_t size() const;
+
+protected:
+    // the header is the child of the parent with _parentHash
+    static bool isChild(bcos::protocol::BlockHeader::Ptr _header,
+        bcos::protocol::BlockNumber _parentNumber, bcos::crypto::HashType const& _parentHash);
+
+private:
+    struct HeaderSegment
+    {
+        bcos::crypto::NodeIDPtr peer;
+        std::vector<bcos::protocol::BlockHeader::Ptr> headers;
+    };
+    // the number and hash of the block the verified headers start from
+    bcos::protocol::BlockNumber m_baseNumber = 0;
+    bcos::crypto::HashType m_baseHash;
+    // the verified headers, start from m_baseNumber + 1
+    std::deque<bcos::protocol::BlockHeader::Ptr> m_headers;
+    // the first number of the segment => the segment
+    std::map<bcos::protocol::BlockNumber, HeaderSegment> m_pendingSegments;
+    mutable Mutex m_mutex;
+};
+}  // namespace sync
+}  // namespace bcos
@@ -0,0 +1,125 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief measure the download performance of the peer
+ * @file PeerScore.cpp
+ * @author: yujiechen
+ * @date 2021-06-18
+ */
+#include "PeerScore.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+
+double PeerScore::updateAverage(double _average, double _value, bool _measured)
+{
+    // the first sample
+    if (!_measured)
+    {
+        return _value;
+    }
+    return (1 - c_sampleWeight) * _average + c_sampleWeight * _value;
+}
+
+void PeerScore::onResponse(uint64_t _timeCost, size_t _bytes, size_t _blocks)
+{
+    auto now = utcTime();
+    Guard l(m_mutex);
+    if (_blocks > 0)
+    {
+        // the block size is only updated by the responses
+        m_blockSize = updateAverage(m_blockSize, (double)_bytes / _blocks, m_blockSize > 0);
+    }
+    m_latency = updateAverage(m_latency, std::max(_timeCost, (uint64_t)1), m_measured);
+    // the failure rate starts from 0 without any failure
+    m_failureRate = updateAverage(m_failureRate, 0, true);
+    m_continuousFailures = 0;
+    m_backoffDeadline = 0;
+    // the concurrent requests are in-flight at the same time, only the time after the previous
+    // response is spent on this one
+    auto busyFrom = std::max(now - std::min(_timeCost, now), m_lastResponseTime);
+    m_windowTime += (now > busyFrom) ? (now - busyFrom) : 0;
+    m_windowBytes += _bytes;
+    m_lastResponseTime = std::max(now, m_lastResponseTime);
+    // measure the new peer by the first response
+    if (m_measured && m_windowTime < c_throughputWindow)
+    {
+        return;
+    }
+    auto windowTime = std::max(m_windowTime, (uint64_t)1);
+    m_throughput =
+        updateAverage(m_throughput, (double)m_windowBytes * 1000 / windowTime, m_measured);
+    m_measured = true;
+    m_windowBytes = 0;
+    m_windowTime = 0;
+}
+
+void PeerScore::onTimeout(uint64_t _backoffTime)
+{
+    Guard l(m_mutex);
+    // the failures do not measure the throughput
+    m_failureRate = updateAverage(m_failureRate, 1, true);
+    auto shift = std::min(m_continuousFailures, c_maxBackoffShift);
+    m_continuousFailures++;
+    m_backoffDeadline = utcTime() + std::min(_backoffTime << shift, c_maxBackoffTime);
+}
+
+double PeerScore::latency() const
+{
+    Guard l(m_mutex);
+    return m_latency;
+}
+
+double PeerScore::throughput() const
+{
+    Guard l(m_mutex);
+    return m_throughput;
+}
+
+double PeerScore::failureRate() const
+{
+    Guard l(m_mutex);
+    return m_failureRate;
+}
+
+double PeerScore::blockSize() const
+{
+    Guard l(m_mutex);
+    return m_blockSize;
+}
+
+double PeerScore::score() const
+{
+    Guard l(m_mutex);
+    return m_throughput * (1 - m_failureRate);
+}
+
+bool PeerScore::measured() const
+{
+    Guard l(m_mutex);
+    return m_measured;
+}
+
+bool PeerScore::backoff() const
+{
+    Guard l(m_mutex);
+    return m_backoffDeadline > utcTime();
+}
+
+uint64_t PeerScore::backoffDeadline() const
+{
+    Guard l(m_mutex);
+    return m_backoffDeadline;
+}
@@ -0,0 +1,89 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief measure the download performance of the peer
+ * @file PeerScore.h
+ * @author: yujiechen
+ * @date 2021-06-18
+ */
+#pragma once
+#include "bcos-sync/utilities/Common.h"
+namespace bcos
+{
+namespace sync
+{
+class PeerScore
+{
+public:
+    using Ptr = std::shared_ptr<PeerScore>;
+    PeerScore() = default;
+    virtual ~PeerScore() {}
+
+    // receive _blocks blocks with _bytes from the peer _timeCost milliseconds after the request
+    // was sent, the throughput is measured by the bytes received in a time window, and the
+    // time overlapped with the previous response is not counted again for the concurrent
+    // requests
+    virtual void onResponse(uint64_t _timeCost, size_t _bytes, size_t _blocks);
+    // the request sent to the peer timed out, the peer is not chosen in the next
+    // min(_backoffTime * 2^(continuousFailures - 1), c_maxBackoffTime) milliseconds
+    virtual void onTimeout(uint64_t _backoffTime);
+
+    // the moving average of the response latency in milliseconds
+    double latency() const;
+    // the moving average of the bytes received per second
+    double throughput() const;
+    // the moving average of the request failure rate
+    double failureRate() const;
+    // the moving average of the encoded block size
+    double blockSize() const;
+    // the expected bytes/s penalized by the failures, 0 if the peer has not been measured
+    virtual double score() const;
+    // the throughput of the peer has been measured by the responses
+    virtual bool measured() const;
+    // the peer is backing off after continuous failures
+    virtual bool backoff() const;
+    // the utc time in milliseconds when the backoff ends, 0 if the peer never backed off
+    virtual uint64_t backoffDeadline() const;
+
+protected:
+    double updateAverage(double _average, double _value, bool _measured);
+
+private:
+    double m_latency = 0;
+    double m_throughput = 0;
+    double m_failureRate = 0;
+    double m_blockSize = 0;
+    bool m_measured = false;
+
+    // the bytes received and the time cost of the current throughput window
+    uint64_t m_windowBytes = 0;
+    uint64_t m_windowTime = 0;
+    uint64_t m_lastResponseTime = 0;
+
+    uint64_t m_continuousFailures = 0;
+    uint64_t m_backoffDeadline = 0;
+    mutable Mutex m_mutex;
+
+    // the weight of the latest sample
+    double const c_sampleWeight = 0.2;
+    // the throughput is sampled once the responses cost 500ms
+    uint64_t const c_throughputWindow = 500;
+    // at most backoff _backoffTime * 2^c_maxBackoffShift
+    uint64_t const c_maxBackoffShift = 5;
+    // the backoff never exceeds 10s whatever the request timeout is
+    uint64_t const c_maxBackoffTime = 10000;
+};
+}  // namespace sync
+}  // namespace bcos
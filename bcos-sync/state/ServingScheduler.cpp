@@ -0,0 +1,162 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief schedule the ledger reads to serve the block requests of the peers
+ * @file ServingScheduler.cpp
+ * @author: yujiechen
+ * @date 2021-06-21
+ */
+#include "ServingScheduler.h"
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::protocol;
+
+ServingScheduler::ServingScheduler(BlockSyncConfig::Ptr _config)
+  : m_config(_config),
+    m_readsBudget(std::make_shared<TokenBucket>(_config->maxServingReadsPerSecond())),
+    m_bytesBudget(std::make_shared<TokenBucket>(_config->maxServingBytesPerSecond()))
+{}
+
+void ServingScheduler::updateBudget(double _loadFactor)
+{
+    m_loadFactor = std::min(std::max(_loadFactor, 0.01), 1.0);
+    m_readsBudget->setRate(m_config->maxServingReadsPerSecond() * m_loadFactor);
+    m_bytesBudget->setRate(m_config->maxServingBytesPerSecond() * m_loadFactor);
+}
+
+size_t ServingScheduler::acquire(TokenBucket::Ptr _peerQuota, size_t _blocks)
+{
+    _peerQuota->setRate(m_config->maxServingReadsPerPeer());
+    if (exhausted())
+    {
+        return 0;
+    }
+    auto blocks = std::min((double)_blocks, _peerQuota->available());
+    blocks = std::min(blocks, m_readsBudget->available());
+    auto maxInFlightReads = m_config->maxServingInFlightReads();
+    if (maxInFlightReads > 0)
+    {
+        blocks = std::min(blocks, (double)(maxInFlightReads - m_inFlightReads));
+    }
+    auto granted = (size_t)blocks;
+    if (granted == 0)
+    {
+        return 0;
+    }
+    _peerQuota->consume(granted);
+    m_readsBudget->consume(granted);
+    m_inFlightReads += granted;
+    return granted;
+}
+
+void ServingScheduler::onCacheHit()
+{
+    m_readsBudget->refund(1);
+    onReadFinished();
+}
+
+bool ServingScheduler::onReadFinished()
+{
+    size_t inFlightReads = --m_inFlightReads;
+    // resume the serving once half of the in-flight reads finished
+    if (!m_backpressured || inFlightReads > m_config->maxServingInFlightReads() / 2)
+    {
+        return false;
+    }
+    return m_backpressured.exchange(false);
+}
+
+bool ServingScheduler::inFlightReadsFull()
+{
+    auto maxInFlightReads = m_config->maxServingInFlightReads();
+    if (maxInFlightReads == 0 || m_inFlightReads < maxInFlightReads)
+    {
+        return false;
+    }
+    m_backpressured = true;
+    return true;
+}
+
+void ServingScheduler::onReadFailed(DownloadRequestQueue::Ptr _reqQueue, BlockNumber _number)
+{
+    m_readErrors++;
+    Guard l(x_failedReads);
+    auto key = std::make_pair(_reqQueue.get(), _number);
+    auto& failedRead = m_failedReads[key];
+    failedRead.reqQueue = _reqQueue;
+    failedRead.number = _number;
+    failedRead.failures++;
+    failedRead.retrying = false;
+    if (failedRead.failures > c_maxRetries)
+    {
+        m_droppedReads++;
+        m_failedReads.erase(key);
+        BLKSYNC_LOG(WARNING) << LOG_BADGE("Download Request")
+                             << LOG_DESC("Drop the block failed to be read")
+                             << LOG_KV("number", _number) << LOG_KV("failures", c_maxRetries + 1);
+        return;
+    }
+    auto shift = std::min(failedRead.failures - 1, c_maxBackoffShift);
+    failedRead.retryTime = utcTime() + (c_retryBackoff << shift);
+}
+
+void ServingScheduler::onReadSucceeded(DownloadRequestQueue::Ptr _reqQueue, BlockNumber _number)
+{
+    Guard l(x_failedReads);
+    if (m_failedReads.empty())
+    {
+        return;
+    }
+    m_failedReads.erase(std::make_pair(_reqQueue.get(), _number));
+}
+
+void ServingScheduler::retryFailedReads(uint64_t _now)
+{
+    Guard l(x_failedReads);
+    for (auto it = m_failedReads.begin(); it != m_failedReads.end();)
+    {
+        auto& failedRead = it->second;
+        // the retried request has been discarded, such as the peer disconnected
+        if (failedRead.retrying && _now > failedRead.retryTime + m_config->requestTimeout())
+        {
+            it = m_failedReads.erase(it);
+            continue;
+        }
+        if (!failedRead.retrying && _now >= failedRead.retryTime)
+        {
+            failedRead.reqQueue->push(failedRead.number, 1);
+            failedRead.retrying = true;
+        }
+        ++it;
+    }
+}
+
+size_t ServingScheduler::retryingReads() const
+{
+    Guard l(x_failedReads);
+    return m_failedReads.size();
+}
+
+void ServingScheduler::onBlockServed(size_t _bytes)
+{
+    m_bytesBudget->consume(_bytes);
+}
+
+bool ServingScheduler::exhausted()
+{
+    return inFlightReadsFull() || m_readsBudget->available() < 1 ||
+           m_bytesBudget->available() <= 0;
+}
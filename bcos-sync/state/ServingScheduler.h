@@ -0,0 +1,104 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief schedule the ledger reads to serve the block requests of the peers
+ * @file ServingScheduler.h
+ * @author: yujiechen
+ * @date 2021-06-21
+ */
+#pragma once
+#include "bcos-sync/BlockSyncConfig.h"
+#include "bcos-sync/state/DownloadRequestQueue.h"
+#include "bcos-sync/state/TokenBucket.h"
+namespace bcos
+{
+namespace sync
+{
+// the blocks served to the peers are limited by the quota of each peer, and the global budget of
+// the ledger reads and the bytes per second, the global budget is scaled by the load factor,
+// and at most maxServingInFlightReads ledger reads are in-flight
+class ServingScheduler
+{
+public:
+    using Ptr = std::shared_ptr<ServingScheduler>;
+    explicit ServingScheduler(BlockSyncConfig::Ptr _config);
+    virtual ~ServingScheduler() {}
+
+    // scale the global budget by _loadFactor in (0, 1], called before every serving round
+    virtual void updateBudget(double _loadFactor);
+    // acquire the ledger reads to serve at most _blocks blocks to the peer with _peerQuota,
+    // return the number of the blocks can be served, every granted read should be finished by
+    // onCacheHit or onReadFinished
+    virtual size_t acquire(TokenBucket::Ptr _peerQuota, size_t _blocks);
+    // the block is served from the cache without reading the ledger
+    virtual void onCacheHit();
+    // the ledger read finished, return true if the serving was blocked by the in-flight reads
+    // and can be scheduled again
+    virtual bool onReadFinished();
+    // the block failed to be read is requested again after c_retryBackoff * 2^(failures - 1) ms,
+    // and dropped after c_maxRetries failures, the requester will request it after timeout
+    virtual void onReadFailed(
+        DownloadRequestQueue::Ptr _reqQueue, bcos::protocol::BlockNumber _number);
+    virtual void onReadSucceeded(
+        DownloadRequestQueue::Ptr _reqQueue, bcos::protocol::BlockNumber _number);
+    // push the failed reads due at _now back to their request queues
+    virtual void retryFailedReads(uint64_t _now);
+    // the bytes of the served block, overdraw the bytes budget if exhausted
+    virtual void onBlockServed(size_t _bytes);
+    // no block can be served until the budget is refilled
+    virtual bool exhausted();
+
+    double loadFactor() const { return m_loadFactor; }
+    TokenBucket::Ptr readsBudget() { return m_readsBudget; }
+    TokenBucket::Ptr bytesBudget() { return m_bytesBudget; }
+    size_t inFlightReads() const { return m_inFlightReads; }
+    uint64_t readErrors() const { return m_readErrors; }
+    // the reads dropped after c_maxRetries failures
+    uint64_t droppedReads() const { return m_droppedReads; }
+    size_t retryingReads() const;
+
+protected:
+    bool inFlightReadsFull();
+
+private:
+    struct FailedRead
+    {
+        DownloadRequestQueue::Ptr reqQueue;
+        bcos::protocol::BlockNumber number;
+        uint64_t failures = 0;
+        uint64_t retryTime = 0;
+        // pushed back to the request queue, and waiting to be read again
+        bool retrying = false;
+    };
+
+    BlockSyncConfig::Ptr m_config;
+    TokenBucket::Ptr m_readsBudget;
+    TokenBucket::Ptr m_bytesBudget;
+    std::atomic<double> m_loadFactor = {1};
+
+    std::atomic<size_t> m_inFlightReads = {0};
+    std::atomic_bool m_backpressured = {false};
+    std::atomic<uint64_t> m_readErrors = {0};
+    std::atomic<uint64_t> m_droppedReads = {0};
+    std::map<std::pair<DownloadRequestQueue*, bcos::protocol::BlockNumber>, FailedRead>
+        m_failedReads;
+    mutable Mutex x_failedReads;
+
+    uint64_t const c_retryBackoff = 100;
+    uint64_t const c_maxBackoffShift = 5;
+    uint64_t const c_maxRetries = 6;
+};
+}  // namespace sync
+}  // namespace bcos
@@ -19,6 +19,7 @@
  * @date 2021-05-24
  */
 #include "SyncPeerStatus.h"
+#include <cmath>
 
 using namespace bcos;
 using namespace bcos::sync;
@@ -29,9 +30,13 @@ PeerStatus::PeerStatus(BlockSyncConfig::Ptr _config, PublicPtr _nodeId, BlockNum
     HashType const& _hash, HashType const& _gensisHash)
   : m_nodeId(_nodeId),
     m_number(_number),
-    m_hash(_hash),
+    m_chainTip(std::make_shared<ChainTip const>(_number, _hash)),
     m_genesisHash(_gensisHash),
-    m_downloadRequests(std::make_shared<DownloadRequestQueue>(_config, m_nodeId))
+    m_downloadRequests(std::make_shared<DownloadRequestQueue>(_config, m_nodeId)),
+    m_headerRequests(std::make_shared<DownloadRequestQueue>(_config, m_nodeId)),
+    m_compactRequests(std::make_shared<DownloadRequestQueue>(_config, m_nodeId)),
+    m_score(std::make_shared<PeerScore>()),
+    m_servingQuota(std::make_shared<TokenBucket>(_config->maxServingReadsPerPeer()))
 {}
 
 PeerStatus::PeerStatus(BlockSyncConfig::Ptr _config, PublicPtr _nodeId)
@@ -41,15 +46,15 @@ PeerStatus::PeerStatus(BlockSyncConfig::Ptr _config, PublicPtr _nodeId)
 PeerStatus::PeerStatus(
     BlockSyncConfig::Ptr _config, PublicPtr _nodeId, BlockSyncStatusInterface::ConstPtr _status)
   : PeerStatus(_config, _nodeId, _status->number(), _status->hash(), _status->genesisHash())
-{}
+{
+    m_version = _status->version();
+    m_capabilities = _status->capabilities();
+}
 
 bool PeerStatus::update(BlockSyncStatusInterface::ConstPtr _status)
 {
+    // serialize the writers, the readers of the chain tip access it without locking
     UpgradableGuard l(x_mutex);
-    if (m_hash == _status->hash() && _status->number() == m_number)
-    {
-        return false;
-    }
     if (m_genesisHash != HashType() && _status->genesisHash() != m_genesisHash)
     {
         BLKSYNC_LOG(WARNING) << LOG_BADGE("Status")
@@ -61,8 +66,18 @@ bool PeerStatus::update(BlockSyncStatusInterface::ConstPtr _status)
         return false;
     }
     UpgradeGuard ul(l);
+    // the wire modes are only changed by the status of the same chain
+    m_version = _status->version();
+    m_capabilities = _status->capabilities();
+    auto tip = chainTip();
+    if (tip->hash == _status->hash() && tip->number == _status->number())
+    {
+        return false;
+    }
+    // publish the hash before the number
+    std::atomic_store(
+        &m_chainTip, std::make_shared<ChainTip const>(_status->number(), _status->hash()));
     m_number = _status->number();
-    m_hash = _status->hash();
     if (m_genesisHash == HashType())
     {
         m_genesisHash = _status->genesisHash();
@@ -76,33 +91,46 @@ bool PeerStatus::update(BlockSyncStatusInterface::ConstPtr _status)
 
 bool SyncPeerStatus::hasPeer(PublicPtr _peer)
 {
-    ReadGuard l(x_peersStatus);
-    return m_peersStatus.count(_peer);
+    return peersSnapshot()->peers.count(_peer);
 }
 
 PeerStatus::Ptr SyncPeerStatus::peerStatus(bcos::crypto::PublicPtr _peer)
 {
-    ReadGuard l(x_peersStatus);
-    if (!m_peersStatus.count(_peer))
+    auto snapshot = peersSnapshot();
+    auto it = snapshot->peers.find(_peer);
+    if (it == snapshot->peers.end())
     {
         return nullptr;
     }
-    return m_peersStatus[_peer];
+    return it->second;
+}
+
+PeerStatus::Ptr SyncPeerStatus::insertPeer(PeerStatus::Ptr _peerStatus)
+{
+    Guard l(x_peersStatus);
+    auto snapshot = peersSnapshot();
+    auto it = snapshot->peers.find(_peerStatus->nodeId());
+    if (it != snapshot->peers.end())
+    {
+        return it->second;
+    }
+    // publish the copy with the new peer
+    auto newSnapshot = std::make_shared<PeersSnapshot>(*snapshot);
+    newSnapshot->peers.insert(std::make_pair(_peerStatus->nodeId(), _peerStatus));
+    newSnapshot->peerList.emplace_back(_peerStatus);
+    std::atomic_store(&m_peersSnapshot, PeersSnapshot::Ptr(newSnapshot));
+    return _peerStatus;
 }
 
 PeerStatus::Ptr SyncPeerStatus::insertEmptyPeer(PublicPtr _peer)
 {
-    WriteGuard l(x_peersStatus);
     // create and insert the new peer status
-    auto peerStatus = std::make_shared<PeerStatus>(m_config, _peer);
-    m_peersStatus.insert(std::make_pair(_peer, peerStatus));
-    return peerStatus;
+    return insertPeer(std::make_shared<PeerStatus>(m_config, _peer));
 }
 
 bool SyncPeerStatus::updatePeerStatus(
     PublicPtr _peer, BlockSyncStatusInterface::ConstPtr _peerStatus)
 {
-    WriteGuard l(x_peersStatus);
     // check the status
     if (_peerStatus->genesisHash() != m_config->genesisHash())
     {
@@ -115,9 +143,9 @@ bool SyncPeerStatus::updatePeerStatus(
         return false;
     }
     // update the existed peer status
-    if (m_peersStatus.count(_peer))
+    auto status = peerStatus(_peer);
+    if (status)
     {
-        auto status = m_peersStatus[_peer];
         if (status->update(_peerStatus))
         {
             updateKnownMaxBlockInfo(_peerStatus);
@@ -125,8 +153,17 @@ bool SyncPeerStatus::updatePeerStatus(
         return true;
     }
     // create and insert the new peer status
-    auto peerStatus = std::make_shared<PeerStatus>(m_config, _peer, _peerStatus);
-    m_peersStatus.insert(std::make_pair(_peer, peerStatus));
+    auto newPeerStatus = std::make_shared<PeerStatus>(m_config, _peer, _peerStatus);
+    status = insertPeer(newPeerStatus);
+    // inserted by others concurrently
+    if (status != newPeerStatus)
+    {
+        if (status->update(_peerStatus))
+        {
+            updateKnownMaxBlockInfo(_peerStatus);
+        }
+        return true;
+    }
     BLKSYNC_LOG(DEBUG) << LOG_DESC("updatePeerStatus: new peer")
                        << LOG_KV("peer", _peer->shortHex())
                        << LOG_KV("number", _peerStatus->number())
@@ -143,67 +180,128 @@ void SyncPeerStatus::updateKnownMaxBlockInfo(BlockSyncStatusInterface::ConstPtr
     {
         return;
     }
-    if (_peerStatus->number() <= m_config->knownHighestNumber())
-    {
-        return;
-    }
-    m_config->setKnownHighestNumber(_peerStatus->number());
-    m_config->setKnownLatestHash(_peerStatus->hash());
+    m_config->updateKnownChainTip(_peerStatus->number(), _peerStatus->hash());
 }
 
 void SyncPeerStatus::deletePeer(PublicPtr _peer)
 {
-    WriteGuard l(x_peersStatus);
-    auto peer = m_peersStatus.find(_peer);
-    if (peer != m_peersStatus.end())
+    Guard l(x_peersStatus);
+    auto snapshot = peersSnapshot();
+    auto peer = snapshot->peers.find(_peer);
+    if (peer == snapshot->peers.end())
     {
-        m_peersStatus.erase(peer);
+        return;
     }
+    // publish the copy without the peer
+    auto peerStatus = peer->second;
+    auto newSnapshot = std::make_shared<PeersSnapshot>(*snapshot);
+    newSnapshot->peers.erase(_peer);
+    auto& peerList = newSnapshot->peerList;
+    peerList.erase(std::remove(peerList.begin(), peerList.end(), peerStatus), peerList.end());
+    std::atomic_store(&m_peersSnapshot, PeersSnapshot::Ptr(newSnapshot));
 }
 
 void SyncPeerStatus::foreachPeerRandom(std::function<bool(PeerStatus::Ptr)> const& _f) const
 {
-    ReadGuard l(x_peersStatus);
-    if (m_peersStatus.empty())
+    auto snapshot = peersSnapshot();
+    if (snapshot->peerList.empty())
     {
         return;
     }
+    // Random peer list
+    auto peerList = snapshot->peerList;
+    for (size_t i = peerList.size() - 1; i > 0; --i)
+    {
+        size_t select = rand() % (i + 1);
+        swap(peerList[i], peerList[select]);
+    }
 
-    // Get nodeid list
-    NodeIDs nodeIds;
-    for (auto& peer : m_peersStatus)
+    // access _f() according to the random list
+    for (auto const& peer : peerList)
     {
-        nodeIds.emplace_back(peer.first);
+        if (peer && !_f(peer))
+        {
+            break;
+        }
     }
+}
 
-    // Random nodeid list
-    for (size_t i = nodeIds.size() - 1; i > 0; --i)
+double SyncPeerStatus::meanScore() const
+{
+    auto snapshot = peersSnapshot();
+    double totalScore = 0;
+    size_t measuredPeers = 0;
+    for (auto const& peer : snapshot->peerList)
     {
-        size_t select = rand() % (i + 1);
-        swap(nodeIds[i], nodeIds[select]);
+        if (!peer->score()->measured())
+        {
+            continue;
+        }
+        totalScore += peer->score()->score();
+        measuredPeers++;
     }
+    if (measuredPeers == 0)
+    {
+        return 0;
+    }
+    return totalScore / measuredPeers;
+}
 
-    // access _f() according to the random list
-    for (auto nodeId : nodeIds)
+void SyncPeerStatus::foreachPeerByScore(std::function<bool(PeerStatus::Ptr)> const& _f) const
+{
+    auto averageScore = meanScore();
+    auto snapshot = peersSnapshot();
+    // weighted random order: sort the peers by u^(1/weight), u is uniform in (0, 1)
+    std::vector<std::pair<double, PeerStatus::Ptr>> weightedPeers;
+    // the backing off peer whose backoff ends soonest
+    PeerStatus::Ptr fallbackPeer = nullptr;
+    uint64_t fallbackDeadline = 0;
+    for (auto const& peer : snapshot->peerList)
     {
-        auto const& peer = m_peersStatus.find(nodeId);
-        if (peer == m_peersStatus.end())
+        auto score = peer->score();
+        if (score->backoff())
         {
+            auto deadline = score->backoffDeadline();
+            if (!fallbackPeer || deadline < fallbackDeadline)
+            {
+                fallbackPeer = peer;
+                fallbackDeadline = deadline;
+            }
             continue;
         }
-        if (peer->second && !_f(peer->second))
+        // the unmeasured peers are treated as average ones penalized by the failures to explore
+        // them, the slow peers keep a small weight to be measured again
+        double weight = std::max(1 - score->failureRate(), c_minWeightRatio);
+        if (averageScore > 0 && score->measured())
         {
-            break;
+            weight = std::max(score->score() / averageScore, c_minWeightRatio);
         }
+        double random = ((double)rand() + 1) / ((double)RAND_MAX + 2);
+        weightedPeers.emplace_back(std::pow(random, 1 / weight), peer);
+    }
+    std::sort(weightedPeers.begin(), weightedPeers.end(),
+        [](auto const& _first, auto const& _second) { return _first.first > _second.first; });
+    for (auto const& peer : weightedPeers)
+    {
+        if (!_f(peer.second))
+        {
+            return;
+        }
+    }
+    // none of the available peers finished the iteration, e.g. all the peers are backing off,
+    // fall back to the peer recovering first instead of stalling until the backoff ends
+    if (fallbackPeer)
+    {
+        _f(fallbackPeer);
     }
 }
 
 void SyncPeerStatus::foreachPeer(std::function<bool(PeerStatus::Ptr)> const& _f) const
 {
-    ReadGuard l(x_peersStatus);
-    for (auto peer : m_peersStatus)
+    auto snapshot = peersSnapshot();
+    for (auto const& peer : snapshot->peerList)
     {
-        if (peer.second && !_f(peer.second))
+        if (peer && !_f(peer))
         {
             break;
         }
@@ -213,8 +311,8 @@ void SyncPeerStatus::foreachPeer(std::function<bool(PeerStatus::Ptr)> const& _f)
 std::shared_ptr<NodeIDs> SyncPeerStatus::peers()
 {
     auto nodeIds = std::make_shared<NodeIDs>();
-    ReadGuard l(x_peersStatus);
-    for (auto& peer : m_peersStatus)
-        nodeIds->emplace_back(peer.first);
+    auto snapshot = peersSnapshot();
+    for (auto const& peer : snapshot->peerList)
+        nodeIds->emplace_back(peer->nodeId());
     return nodeIds;
 }
\ No newline at end of file
@@ -22,7 +22,11 @@
 #include "bcos-sync/BlockSyncConfig.h"
 #include "bcos-sync/interfaces/BlockSyncStatusInterface.h"
 #include "bcos-sync/state/DownloadRequestQueue.h"
+#include "bcos-sync/state/PeerScore.h"
+#include "bcos-sync/state/TokenBucket.h"
 #include "bcos-sync/utilities/Common.h"
+#include <boost/functional/hash.hpp>
+#include <unordered_map>
 namespace bcos
 {
 namespace sync
@@ -45,41 +49,96 @@ public:
 
     bcos::crypto::PublicPtr nodeId() { return m_nodeId; }
 
-    bcos::protocol::BlockNumber number() const
+    // the number is published after the chain tip
+    bcos::protocol::BlockNumber number() const { return m_number; }
+    bcos::crypto::HashType hash() const { return chainTip()->hash; }
+    // the latest number and hash of the peer
+    ChainTip::ConstPtr chainTip() const { return std::atomic_load(&m_chainTip); }
+
+    bcos::crypto::HashType genesisHash() const
     {
         ReadGuard l(x_mutex);
-        return m_number;
+        return m_genesisHash;
     }
 
-    bcos::crypto::HashType const& hash() const
+    // the block sync version of the peer
+    int32_t version() const { return m_version; }
+    // the bitmap of BlockSyncCapability supported by the peer
+    uint64_t capabilities() const { return m_capabilities; }
+    bool supports(uint64_t _capability) const { return (m_capabilities & _capability) != 0; }
+
+    DownloadRequestQueue::Ptr downloadRequests() { return m_downloadRequests; }
+    // the requests for the headers only
+    DownloadRequestQueue::Ptr headerRequests() { return m_headerRequests; }
+    // the requests for the compact blocks
+    DownloadRequestQueue::Ptr compactRequests() { return m_compactRequests; }
+    PeerScore::Ptr score() { return m_score; }
+    // the quota of the blocks served to the peer
+    TokenBucket::Ptr servingQuota() { return m_servingQuota; }
+    // some requests of the peer are waiting to be served
+    bool hasPendingRequests()
     {
-        ReadGuard l(x_mutex);
-        return m_hash;
+        return !m_headerRequests->empty() || !m_compactRequests->empty() ||
+               !m_downloadRequests->empty();
     }
-
-    bcos::crypto::HashType const& genesisHash() const
+    size_t pendingRequests()
     {
-        ReadGuard l(x_mutex);
-        return m_genesisHash;
+        return m_headerRequests->size() + m_compactRequests->size() + m_downloadRequests->size();
     }
 
-    DownloadRequestQueue::Ptr downloadRequests() { return m_downloadRequests; }
-
 private:
     bcos::crypto::PublicPtr m_nodeId;
-    bcos::protocol::BlockNumber m_number;
-    bcos::crypto::HashType m_hash;
+    std::atomic<bcos::protocol::BlockNumber> m_number;
+    // accessed by std::atomic_load and std::atomic_store
+    ChainTip::ConstPtr m_chainTip;
     bcos::crypto::HashType m_genesisHash;
+    std::atomic<int32_t> m_version = {BlockSyncMsgVersion::VERSION_0};
+    std::atomic<uint64_t> m_capabilities = {0};
 
     mutable SharedMutex x_mutex;
     DownloadRequestQueue::Ptr m_downloadRequests;
+    DownloadRequestQueue::Ptr m_headerRequests;
+    DownloadRequestQueue::Ptr m_compactRequests;
+    PeerScore::Ptr m_score;
+    TokenBucket::Ptr m_servingQuota;
 };
 
+struct NodeIDHasher
+{
+    size_t operator()(bcos::crypto::PublicPtr const& _nodeID) const
+    {
+        return boost::hash_range(_nodeID->data().begin(), _nodeID->data().end());
+    }
+};
+
+struct NodeIDEqual
+{
+    bool operator()(
+        bcos::crypto::PublicPtr const& _first, bcos::crypto::PublicPtr const& _second) const
+    {
+        return _first->data() == _second->data();
+    }
+};
+
+// the immutable snapshot of the peers, replaced as a whole once a peer inserted or deleted
+struct PeersSnapshot
+{
+    using Ptr = std::shared_ptr<PeersSnapshot const>;
+    std::unordered_map<bcos::crypto::PublicPtr, PeerStatus::Ptr, NodeIDHasher, NodeIDEqual>
+        peers;
+    // the peers in the order inserted
+    std::vector<PeerStatus::Ptr> peerList;
+};
+
+// the readers access the latest snapshot of the peers without locking, the writers inserting
+// or deleting peers are serialized, and the status of the existed peer is updated in place
 class SyncPeerStatus
 {
 public:
     using Ptr = std::shared_ptr<SyncPeerStatus>;
-    explicit SyncPeerStatus(BlockSyncConfig::Ptr _config) : m_config(_config) {}
+    explicit SyncPeerStatus(BlockSyncConfig::Ptr _config)
+      : m_config(_config), m_peersSnapshot(std::make_shared<PeersSnapshot>())
+    {}
     virtual ~SyncPeerStatus() {}
 
     virtual bool hasPeer(bcos::crypto::PublicPtr _peer);
@@ -89,18 +148,30 @@ public:
     virtual void deletePeer(bcos::crypto::PublicPtr _peer);
 
     void foreachPeerRandom(std::function<bool(PeerStatus::Ptr)> const& _f) const;
+    // access the peers in a random order weighted by the score, the faster peers are accessed
+    // earlier with higher probability, the backing-off peers are skipped unless the iteration
+    // is not stopped by the others, then the one whose backoff ends soonest is accessed last
+    void foreachPeerByScore(std::function<bool(PeerStatus::Ptr)> const& _f) const;
+    // the average score of the measured peers, 0 if no peer has been measured
+    double meanScore() const;
     void foreachPeer(std::function<bool(PeerStatus::Ptr)> const& _f) const;
     std::shared_ptr<bcos::crypto::NodeIDs> peers();
     PeerStatus::Ptr insertEmptyPeer(bcos::crypto::PublicPtr _peer);
 
+    PeersSnapshot::Ptr peersSnapshot() const { return std::atomic_load(&m_peersSnapshot); }
+
 protected:
     virtual void updateKnownMaxBlockInfo(BlockSyncStatusInterface::ConstPtr _peerStatus);
+    // insert the peer if not existed, return the peer in the table
+    PeerStatus::Ptr insertPeer(PeerStatus::Ptr _peerStatus);
 
 private:
-    std::map<bcos::crypto::PublicPtr, PeerStatus::Ptr, bcos::crypto::KeyCompare> m_peersStatus;
-    mutable SharedMutex x_peersStatus;
-
     BlockSyncConfig::Ptr m_config;
+    PeersSnapshot::Ptr m_peersSnapshot;
+    // serialize the writers of the snapshot
+    mutable Mutex x_peersStatus;
+    // the min weight of a peer relative to the mean score
+    double const c_minWeightRatio = 0.05;
 };
 }  // namespace sync
 }  // namespace bcos
\ No newline at end of file
@@ -0,0 +1,97 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief the token bucket to limit the rate of serving the blocks
+ * @file TokenBucket.cpp
+ * @author: yujiechen
+ * @date 2021-06-21
+ */
+#include "TokenBucket.h"
+#include <limits>
+
+using namespace bcos;
+using namespace bcos::sync;
+
+TokenBucket::TokenBucket(double _rate) : m_rate(std::max(_rate, 0.0)), m_lastRefillTime(utcTime())
+{
+    // start full
+    m_tokens = m_rate * c_burstTime / 1000;
+}
+
+void TokenBucket::refill(uint64_t _now)
+{
+    if (_now <= m_lastRefillTime)
+    {
+        return;
+    }
+    auto burst = m_rate * c_burstTime / 1000;
+    m_tokens = std::min(m_tokens + m_rate * (_now - m_lastRefillTime) / 1000, burst);
+    m_lastRefillTime = _now;
+}
+
+double TokenBucket::available(uint64_t _now)
+{
+    Guard l(m_mutex);
+    if (m_rate == 0)
+    {
+        return std::numeric_limits<double>::max();
+    }
+    refill(_now);
+    return std::max(m_tokens, 0.0);
+}
+
+void TokenBucket::consume(double _tokens)
+{
+    Guard l(m_mutex);
+    if (m_rate == 0)
+    {
+        return;
+    }
+    m_tokens -= _tokens;
+}
+
+void TokenBucket::refund(double _tokens)
+{
+    Guard l(m_mutex);
+    if (m_rate == 0)
+    {
+        return;
+    }
+    m_tokens = std::min(m_tokens + _tokens, m_rate * c_burstTime / 1000);
+}
+
+double TokenBucket::rate() const
+{
+    Guard l(m_mutex);
+    return m_rate;
+}
+
+void TokenBucket::setRate(double _rate)
+{
+    Guard l(m_mutex);
+    _rate = std::max(_rate, 0.0);
+    if (_rate == m_rate)
+    {
+        return;
+    }
+    refill(utcTime());
+    // start full when the limit is enabled
+    if (m_rate == 0)
+    {
+        m_tokens = _rate * c_burstTime / 1000;
+    }
+    m_rate = _rate;
+    m_tokens = std::min(m_tokens, m_rate * c_burstTime / 1000);
+}
@@ -0,0 +1,62 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief the token bucket to limit the rate of serving the blocks
+ * @file TokenBucket.h
+ * @author: yujiechen
+ * @date 2021-06-21
+ */
+#pragma once
+#include "bcos-sync/utilities/Common.h"
+namespace bcos
+{
+namespace sync
+{
+// the tokens are refilled at rate per second, and at most rate * c_burstTime / 1000 tokens are
+// kept, the tokens can be overdrawn by the cost only known afterwards, such as the bytes of the
+// fetched blocks, and no token is available until the debt is repaid
+class TokenBucket
+{
+public:
+    using Ptr = std::shared_ptr<TokenBucket>;
+    // _rate 0 means unlimited
+    explicit TokenBucket(double _rate);
+    virtual ~TokenBucket() {}
+
+    // the tokens available at _now (ms)
+    virtual double available(uint64_t _now);
+    double available() { return available(utcTime()); }
+    virtual void consume(double _tokens);
+    // return the tokens consumed but not used
+    virtual void refund(double _tokens);
+
+    double rate() const;
+    void setRate(double _rate);
+    bool unlimited() const { return rate() == 0; }
+
+protected:
+    void refill(uint64_t _now);
+
+private:
+    double m_rate;
+    double m_tokens;
+    uint64_t m_lastRefillTime;
+    mutable Mutex m_mutex;
+
+    // the tokens refilled in c_burstTime ms can be consumed at once
+    uint64_t const c_burstTime = 1000;
+};
+}  // namespace sync
+}  // namespace bcos
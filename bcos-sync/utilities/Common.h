@@ -20,6 +20,7 @@
  */
 #pragma once
 #include <bcos-framework/libutilities/Log.h>
+#include <chrono>
 
 #define BLKSYNC_LOG(LEVEL) BCOS_LOG(LEVEL) << LOG_BADGE("BLOCK SYNC")
 namespace bcos
@@ -32,6 +33,36 @@ enum BlockSyncPacketType : int32_t
     BlockRequestPacket = 0x01,
     BlockResponsePacket = 0x02,
 };
+// the version of the block sync protocol, carried by all the block sync messages
+enum BlockSyncMsgVersion : int32_t
+{
+    VERSION_0 = 0x00,  //< the initial version
+    VERSION_1 = 0x01,  //< the status packet carries the capabilities
+};
+int32_t const c_blockSyncVersion = BlockSyncMsgVersion::VERSION_1;
+// the optional features of the block sync protocol, exchanged by the status packet, a feature
+// is used with a peer only when both sides support it
+enum BlockSyncCapability : uint64_t
+{
+    CAP_COMPRESS_ZSTD = 0x01,  //< the large blocks can be sent compressed with zstd
+    CAP_HEADER_FIRST = 0x02,   //< the headers can be requested without the transactions
+    CAP_COMPACT_BLOCK = 0x04,  //< the blocks can be sent with the transaction hashes only
+};
+uint64_t const c_blockSyncCapabilities = BlockSyncCapability::CAP_COMPRESS_ZSTD |
+                                         BlockSyncCapability::CAP_HEADER_FIRST |
+                                         BlockSyncCapability::CAP_COMPACT_BLOCK;
+enum BlockCompressType : int32_t
+{
+    CompressNone = 0x00,
+    CompressZstd = 0x01,
+};
+// the monotonic time in microseconds, to measure the costs shorter than a millisecond
+inline uint64_t steadyTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
 enum SyncState : int32_t
 {
     Idle = 0x00,         //< Initial chain sync complete. Waiting for new packets
@@ -0,0 +1,68 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief compress the blocks data with zstd
+ * @file ZstdCompress.cpp
+ * @author: yujiechen
+ * @date 2021-06-20
+ */
+#include "ZstdCompress.h"
+#include "bcos-sync/utilities/Common.h"
+#include <zstd.h>
+
+using namespace bcos;
+using namespace bcos::sync;
+
+bool ZstdCompress::compress(bytesConstRef _data, bytes& _compressedData, int _compressLevel)
+{
+    auto compressBound = ZSTD_compressBound(_data.size());
+    _compressedData.resize(compressBound);
+    auto compressedSize = ZSTD_compress(
+        _compressedData.data(), compressBound, _data.data(), _data.size(), _compressLevel);
+    if (ZSTD_isError(compressedSize))
+    {
+        BLKSYNC_LOG(WARNING) << LOG_DESC("ZstdCompress: compress failed")
+                             << LOG_KV("size", _data.size())
+                             << LOG_KV("error", ZSTD_getErrorName(compressedSize));
+        return false;
+    }
+    _compressedData.resize(compressedSize);
+    return true;
+}
+
+bool ZstdCompress::uncompress(bytesConstRef _compressedData, bytes& _data, size_t _rawSize)
+{
+    // check the size recorded in the frame before allocating the memory
+    auto contentSize = ZSTD_getFrameContentSize(_compressedData.data(), _compressedData.size());
+    if (contentSize == ZSTD_CONTENTSIZE_ERROR || contentSize == ZSTD_CONTENTSIZE_UNKNOWN ||
+        contentSize != _rawSize)
+    {
+        BLKSYNC_LOG(WARNING) << LOG_DESC("ZstdCompress: invalid compressed data")
+                             << LOG_KV("size", _compressedData.size())
+                             << LOG_KV("rawSize", _rawSize);
+        return false;
+    }
+    _data.resize(_rawSize);
+    auto uncompressedSize =
+        ZSTD_decompress(_data.data(), _rawSize, _compressedData.data(), _compressedData.size());
+    if (ZSTD_isError(uncompressedSize) || uncompressedSize != _rawSize)
+    {
+        BLKSYNC_LOG(WARNING) << LOG_DESC("ZstdCompress: uncompress failed")
+                             << LOG_KV("size", _compressedData.size())
+                             << LOG_KV("rawSize", _rawSize);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,37 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief compress the blocks data with zstd
+ * @file ZstdCompress.h
+ * @author: yujiechen
+ * @date 2021-06-20
+ */
+#pragma once
+#include <bcos-framework/libutilities/Common.h>
+namespace bcos
+{
+namespace sync
+{
+class ZstdCompress
+{
+public:
+    // compress _data into _compressedData, return false if failed
+    static bool compress(bytesConstRef _data, bytes& _compressedData, int _compressLevel = 1);
+    // uncompress _compressedData into _data, return false if failed or the size of the
+    // uncompressed data is not _rawSize
+    static bool uncompress(bytesConstRef _compressedData, bytes& _data, size_t _rawSize);
+};
+}  // namespace sync
+}  // namespace bcos
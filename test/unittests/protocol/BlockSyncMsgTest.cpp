@@ -19,6 +19,7 @@
  * @date 2021-06-08
  */
 #include "bcos-sync/protocol/PB/BlockSyncMsgFactoryImpl.h"
+#include "bcos-sync/utilities/ZstdCompress.h"
 #include <bcos-framework/testutils/TestPromptFixture.h>
 #include <bcos-framework/testutils/crypto/HashImpl.h>
 #include <boost/test/unit_test.hpp>
@@ -60,6 +61,7 @@ inline BlockSyncMsgInterface::Ptr testSyncMsg(int32_t _packetType, BlockNumber _
         auto statusMsg = factory->createBlockSyncStatusMsg();
         statusMsg->setHash(_hash);
         statusMsg->setGenesisHash(_genesisHash);
+        statusMsg->setCapabilities(c_blockSyncCapabilities);
         syncMsg = statusMsg;
         break;
     }
@@ -102,6 +104,14 @@ inline BlockSyncMsgInterface::Ptr testSyncMsg(int32_t _packetType, BlockNumber _
         auto statusMsg = factory->createBlockSyncStatusMsg(decodedBasicMsg);
         BOOST_CHECK(statusMsg->hash().asBytes() == _hash.asBytes());
         BOOST_CHECK(statusMsg->genesisHash().asBytes() == _genesisHash.asBytes());
+        BOOST_CHECK(statusMsg->capabilities() == c_blockSyncCapabilities);
+        // the status from the old version carries no capabilities
+        auto oldStatusMsg = factory->createBlockSyncStatusMsg();
+        oldStatusMsg->setHash(_hash);
+        auto decodedOldStatusMsg = factory->createBlockSyncStatusMsg(
+            factory->createBlockSyncMsg(ref(*oldStatusMsg->encode())));
+        BOOST_CHECK(decodedOldStatusMsg->capabilities() == 0);
+        BOOST_CHECK(decodedOldStatusMsg->version() == BlockSyncMsgVersion::VERSION_0);
         break;
     }
     case BlockSyncPacketType::BlockRequestPacket:
@@ -120,6 +130,24 @@ inline BlockSyncMsgInterface::Ptr testSyncMsg(int32_t _packetType, BlockNumber _
             auto decodedData = responseMsg->blockData(i++);
             BOOST_CHECK(data == decodedData.toBytes());
         }
+        // decode without copying the blocks data
+        auto receivedData = std::make_shared<bytes>(*encodedData);
+        auto receivedMsg =
+            factory->createBlocksMsg(factory->createBlockSyncMsg(bytesConstPtr(receivedData)));
+        checkBasic(receivedMsg, _packetType, _blockNumber, _version);
+        BOOST_CHECK(receivedMsg->blocksSize() == _blockData.size());
+        for (size_t i = 0; i < _blockData.size(); i++)
+        {
+            auto blockData = receivedMsg->blockData(i);
+            BOOST_CHECK(blockData.toBytes() == _blockData[i]);
+            if (blockData.size() > 0)
+            {
+                BOOST_CHECK(blockData.data() >= receivedData->data() &&
+                            blockData.data() + blockData.size() <=
+                                receivedData->data() + receivedData->size());
+            }
+        }
+        BOOST_CHECK(*receivedMsg->encode() == *encodedData);
         break;
     }
     default:
@@ -154,6 +182,79 @@ BOOST_AUTO_TEST_CASE(testBlockSyncMsg)
     testSyncMsg(BlockSyncPacketType::BlockResponsePacket, blockNumber, version, hash, genesisHash,
         requestedSize, blockData);
 }
+
+BOOST_AUTO_TEST_CASE(testBlocksMsgWithoutCopy)
+{
+    auto factory = std::make_shared<BlockSyncMsgFactoryImpl>();
+    auto blocksMsg = factory->createBlocksMsg();
+    // the moved block data is kept without copying
+    bytes movedData(1024, 1);
+    auto movedDataPtr = movedData.data();
+    blocksMsg->appendBlockData(std::move(movedData));
+    // the shared block data (e.g. the cached encoded block) is kept without copying
+    auto sharedData = std::make_shared<bytes>(2048, 2);
+    blocksMsg->appendBlockData(bytesConstPtr(sharedData));
+    BOOST_CHECK(blocksMsg->blocksSize() == 2);
+    BOOST_CHECK(blocksMsg->blockData(0).data() == movedDataPtr);
+    BOOST_CHECK(blocksMsg->blockData(1).data() == sharedData->data());
+
+    // every block is written into the encoded data only once
+    blocksMsg->setNumber(100);
+    auto encodedData = blocksMsg->encode();
+    BOOST_CHECK(encodedData->size() > 1024 + 2048);
+    BOOST_CHECK(encodedData->size() < 1024 + 2048 + 32);
+    auto decodedMsg = factory->createBlocksMsg(factory->createBlockSyncMsg(ref(*encodedData)));
+    BOOST_CHECK(decodedMsg->number() == 100);
+    BOOST_CHECK(decodedMsg->blocksSize() == 2);
+    BOOST_CHECK(decodedMsg->blockData(0).toBytes() == bytes(1024, 1));
+    BOOST_CHECK(decodedMsg->blockData(1).toBytes() == *sharedData);
+}
+BOOST_AUTO_TEST_CASE(testCompressedBlocksMsg)
+{
+    auto factory = std::make_shared<BlockSyncMsgFactoryImpl>();
+    auto blocksMsg = factory->createBlocksMsg();
+    bytes rawData(10000, 'a');
+    auto compressedData = std::make_shared<bytes>();
+    BOOST_CHECK(ZstdCompress::compress(ref(rawData), *compressedData));
+    BOOST_CHECK(compressedData->size() < rawData.size());
+
+    // the small block is not compressed
+    bytes smallData(10, 'b');
+    blocksMsg->appendBlockData(smallData);
+    blocksMsg->setCompressType(BlockCompressType::CompressZstd);
+    blocksMsg->appendCompressedBlockData(compressedData, rawData.size());
+    blocksMsg->appendBlockData(smallData);
+    BOOST_CHECK(blocksMsg->blockRawSize(0) == 0);
+    BOOST_CHECK(blocksMsg->blockRawSize(1) == (int64_t)rawData.size());
+    BOOST_CHECK(blocksMsg->blockRawSize(2) == 0);
+
+    auto encodedData = blocksMsg->encode();
+    auto decodedMsg = factory->createBlocksMsg(factory->createBlockSyncMsg(ref(*encodedData)));
+    BOOST_CHECK(decodedMsg->compressType() == BlockCompressType::CompressZstd);
+    BOOST_CHECK(decodedMsg->blocksSize() == 3);
+    BOOST_CHECK(decodedMsg->blockRawSize(0) == 0);
+    BOOST_CHECK(decodedMsg->blockData(0).toBytes() == smallData);
+    BOOST_CHECK(decodedMsg->blockRawSize(2) == 0);
+    BOOST_CHECK(decodedMsg->blockData(2).toBytes() == smallData);
+
+    bytes uncompressedData;
+    BOOST_CHECK(ZstdCompress::uncompress(
+        decodedMsg->blockData(1), uncompressedData, decodedMsg->blockRawSize(1)));
+    BOOST_CHECK(uncompressedData == rawData);
+    // mismatched raw size
+    BOOST_CHECK(!ZstdCompress::uncompress(
+        decodedMsg->blockData(1), uncompressedData, decodedMsg->blockRawSize(1) + 1));
+    // invalid compressed data
+    BOOST_CHECK(!ZstdCompress::uncompress(ref(smallData), uncompressedData, rawData.size()));
+
+    // the message without compressed blocks is compatible with the old version
+    auto rawMsg = factory->createBlocksMsg();
+    rawMsg->appendBlockData(smallData);
+    auto decodedRawMsg =
+        factory->createBlocksMsg(factory->createBlockSyncMsg(ref(*rawMsg->encode())));
+    BOOST_CHECK(decodedRawMsg->compressType() == BlockCompressType::CompressNone);
+    BOOST_CHECK(decodedRawMsg->blockRawSize(0) == 0);
+}
 BOOST_AUTO_TEST_SUITE_END()
 }  // namespace test
 }  // namespace bcos
\ No newline at end of file
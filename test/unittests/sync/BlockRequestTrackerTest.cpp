@@ -0,0 +1,89 @@
+/**
+ *  Copyright (C) 2021 bcos-sync.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the BlockRequestTracker
+ * @file BlockRequestTrackerTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-17
+ */
+#include "SyncFixture.h"
+#include "bcos-sync/state/BlockRequestTracker.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <bcos-framework/testutils/crypto/SignatureImpl.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(BlockRequestTrackerTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(testBlockRequestTracker)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+
+    auto peer = faker->nodeID();
+    auto tracker = std::make_shared<BlockRequestTracker>(config);
+    tracker->onRequested(peer, 10, 17);
+    tracker->onRequested(peer, 18, 25);
+    BOOST_CHECK(tracker->inFlightBlocks() == 16);
+    BOOST_CHECK(tracker->inFlightBlocks(peer) == 16);
+
+    // receive [12, 14], only the holes should be requested again
+    tracker->onReceived(12, 3);
+    BOOST_CHECK(tracker->inFlightBlocks() == 13);
+    auto missingRanges = tracker->excludeInFlight({BlockRange(5, 30)});
+    BOOST_CHECK(missingRanges.size() == 3);
+    BOOST_CHECK(missingRanges[0] == BlockRange(5, 9));
+    BOOST_CHECK(missingRanges[1] == BlockRange(12, 14));
+    BOOST_CHECK(missingRanges[2] == BlockRange(26, 30));
+    auto requests = tracker->requests();
+    BOOST_CHECK(requests.size() == 3);
+    BOOST_CHECK(requests[0].from == 10 && requests[0].to == 11);
+    BOOST_CHECK(requests[1].from == 15 && requests[1].to == 17);
+    BOOST_CHECK(requests[1].peer->data() == peer->data());
+
+    // the committed blocks are no longer in-flight
+    tracker->clearExpired(15);
+    BOOST_CHECK(tracker->inFlightBlocks() == 10);
+    BOOST_CHECK(tracker->expire().empty());
+
+    // re-request the in-flight blocks
+    tracker->onRequested(peer, 16, 20);
+    BOOST_CHECK(tracker->inFlightBlocks() == 10);
+
+    // the timed-out range
+    config->setRequestTimeout(0);
+    tracker->onRequested(peer, 30, 31);
+    auto expiredRequests = tracker->expire();
+    BOOST_CHECK(expiredRequests.size() == 1);
+    BOOST_CHECK(expiredRequests[0].from == 30 && expiredRequests[0].to == 31);
+    BOOST_CHECK(tracker->excludeInFlight({BlockRange(30, 31)}).size() == 1);
+
+    tracker->clear();
+    BOOST_CHECK(tracker->empty());
+}
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
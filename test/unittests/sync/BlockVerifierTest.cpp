@@ -0,0 +1,103 @@
+/**
+ *  Copyright (C) 2021 bcos-sync.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the BlockVerifier
+ * @file BlockVerifierTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-23
+ */
+#include "SyncFixture.h"
+#include "bcos-sync/state/BlockVerifier.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <bcos-framework/testutils/crypto/SignatureImpl.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(BlockVerifierTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(testBlockVerifier)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+    auto blockFactory = config->blockFactory();
+
+    auto verifier = std::make_shared<BlockVerifier>(config);
+    auto validBlock = fakeBlockWithNumber(blockFactory, 5);
+    BOOST_CHECK(verifier->result(validBlock) == BlockVerifier::VerifyResult::Unverified);
+    faker->consensus()->setCheckBlockResult(true);
+    verifier->asyncVerify(validBlock);
+    BOOST_CHECK(verifier->result(validBlock) == BlockVerifier::VerifyResult::Valid);
+
+    // the verified block is checked with the cached result
+    faker->consensus()->setCheckBlockResult(false);
+    bool checked = false;
+    verifier->asyncCheckBlock(validBlock, [&checked](Error::Ptr _error, bool _ret) {
+        BOOST_CHECK(_error == nullptr);
+        checked = _ret;
+    });
+    BOOST_CHECK(checked);
+
+    // the block with invalid signatures
+    auto invalidBlock = fakeBlockWithNumber(blockFactory, 6);
+    verifier->asyncVerify(invalidBlock);
+    BOOST_CHECK(verifier->result(invalidBlock) == BlockVerifier::VerifyResult::Invalid);
+    checked = true;
+    verifier->asyncCheckBlock(invalidBlock, [&checked](Error::Ptr, bool _ret) { checked = _ret; });
+    BOOST_CHECK(!checked);
+    BOOST_CHECK(verifier->size() == 2);
+
+    // the valid block received with the forged signatures first is verified again with the
+    // valid signatures
+    auto forgedBlock = fakeBlockWithNumber(blockFactory, 7);
+    forgedBlock->blockHeader()->setSignatureList(SignatureList{Signature{0, bytes(65, 1)}});
+    verifier->asyncVerify(forgedBlock);
+    BOOST_CHECK(verifier->result(forgedBlock) == BlockVerifier::VerifyResult::Invalid);
+    auto signedBlock = fakeBlockWithNumber(blockFactory, 7);
+    signedBlock->blockHeader()->setSignatureList(SignatureList{Signature{0, bytes(65, 2)}});
+    BOOST_CHECK(signedBlock->blockHeader()->hash() == forgedBlock->blockHeader()->hash());
+    BOOST_CHECK(verifier->result(signedBlock) == BlockVerifier::VerifyResult::Unverified);
+    faker->consensus()->setCheckBlockResult(true);
+    verifier->asyncVerify(signedBlock);
+    BOOST_CHECK(verifier->result(signedBlock) == BlockVerifier::VerifyResult::Valid);
+    BOOST_CHECK(verifier->result(forgedBlock) == BlockVerifier::VerifyResult::Unverified);
+    // the forged copy of the valid block is checked instead of using the valid result
+    faker->consensus()->setCheckBlockResult(false);
+    checked = true;
+    verifier->asyncCheckBlock(forgedBlock, [&checked](Error::Ptr, bool _ret) { checked = _ret; });
+    BOOST_CHECK(!checked);
+    BOOST_CHECK(verifier->result(signedBlock) == BlockVerifier::VerifyResult::Valid);
+    BOOST_CHECK(verifier->size() == 3);
+
+    // the results of the committed blocks are removed
+    verifier->clearExpired(6);
+    BOOST_CHECK(verifier->size() == 1);
+    BOOST_CHECK(verifier->result(validBlock) == BlockVerifier::VerifyResult::Unverified);
+    verifier->clear();
+    BOOST_CHECK(verifier->size() == 0);
+}
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
@@ -0,0 +1,106 @@
+/**
+ *  Copyright (C) 2021 bcos-sync.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the BlockWindow
+ * @file BlockWindowTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-16
+ */
+#include "SyncFixture.h"
+#include "bcos-sync/state/BlockWindow.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <bcos-framework/testutils/crypto/SignatureImpl.h>
+#include <bcos-framework/testutils/faker/FakeBlock.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+using namespace bcos::protocol;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(BlockWindowTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(testBlockWindow)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto blockFactory = createBlockFactory(cryptoSuite);
+
+    BlockWindow window(8);
+    window.setBase(10);
+    // out of the window
+    BOOST_CHECK(!window.insert(fakeBlockWithNumber(blockFactory, 9)));
+    BOOST_CHECK(!window.insert(fakeBlockWithNumber(blockFactory, 18)));
+
+    BOOST_CHECK(window.insert(fakeBlockWithNumber(blockFactory, 13)));
+    BOOST_CHECK(window.insert(fakeBlockWithNumber(blockFactory, 11)));
+    // duplicated block
+    BOOST_CHECK(!window.insert(fakeBlockWithNumber(blockFactory, 11)));
+    BOOST_CHECK(window.size() == 2);
+    BOOST_CHECK(window.topNumber() == 11);
+    BOOST_CHECK(window.top()->blockHeader()->number() == 11);
+
+    // the missing ranges are clipped by the window
+    auto missingRanges = window.missingRanges(10, 30);
+    BOOST_CHECK(missingRanges.size() == 3);
+    BOOST_CHECK(missingRanges[0] == BlockRange(10, 10));
+    BOOST_CHECK(missingRanges[1] == BlockRange(12, 12));
+    BOOST_CHECK(missingRanges[2] == BlockRange(14, 17));
+
+    window.pop();
+    BOOST_CHECK(window.size() == 1);
+    BOOST_CHECK(window.topNumber() == 13);
+
+    // move the window forward
+    BOOST_CHECK(window.insert(fakeBlockWithNumber(blockFactory, 17)));
+    window.setBase(14);
+    BOOST_CHECK(window.size() == 1);
+    BOOST_CHECK(!window.contains(13));
+    BOOST_CHECK(window.topNumber() == 17);
+    BOOST_CHECK(window.insert(fakeBlockWithNumber(blockFactory, 21)));
+
+    // move the window backward
+    window.setBase(12);
+    BOOST_CHECK(window.size() == 1);
+    BOOST_CHECK(!window.contains(21));
+    BOOST_CHECK(window.get(17)->blockHeader()->number() == 17);
+
+    // enlarge the window
+    BOOST_CHECK(window.insert(fakeBlockWithNumber(blockFactory, 19)));
+    window.resize(16);
+    BOOST_CHECK(window.capacity() == 16);
+    BOOST_CHECK(window.size() == 2);
+    BOOST_CHECK(window.contains(17) && window.contains(19));
+    BOOST_CHECK(window.insert(fakeBlockWithNumber(blockFactory, 27)));
+    // shrink the window, the blocks out of the window are dropped
+    window.resize(6);
+    BOOST_CHECK(window.size() == 1);
+    BOOST_CHECK(!window.contains(19));
+    BOOST_CHECK(!window.contains(27));
+    BOOST_CHECK(window.topNumber() == 17);
+
+    window.clear();
+    BOOST_CHECK(window.empty());
+    BOOST_CHECK(window.top() == nullptr);
+}
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
@@ -0,0 +1,114 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for DownloadRequestQueue
+ * @file DownloadRequestQueueTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-22
+ */
+#include "SyncFixture.h"
+#include "bcos-sync/state/DownloadRequestQueue.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <bcos-framework/testutils/crypto/SignatureImpl.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(DownloadRequestQueueTest, TestPromptFixture)
+
+inline void checkTopAndPop(DownloadRequestQueue::Ptr _reqQueue, BlockNumber _from, size_t _size)
+{
+    auto request = _reqQueue->topAndPop();
+    BOOST_CHECK(request != nullptr);
+    BOOST_CHECK_EQUAL(request->fromNumber(), _from);
+    BOOST_CHECK_EQUAL(request->size(), _size);
+}
+
+BOOST_AUTO_TEST_CASE(testMergeRequests)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+    auto reqQueue = std::make_shared<DownloadRequestQueue>(config, config->nodeID());
+    BOOST_CHECK(reqQueue->empty());
+    BOOST_CHECK(reqQueue->topAndPop() == nullptr);
+
+    // [1, 4), [1, 5), [2, 3), [2, 6), [6, 8) are merged into [1, 8)
+    reqQueue->push(1, 3);
+    reqQueue->push(1, 4);
+    reqQueue->push(2, 1);
+    reqQueue->push(2, 4);
+    reqQueue->push(6, 2);
+    reqQueue->push(10, 2);
+    BOOST_CHECK_EQUAL(reqQueue->size(), 2);
+    BOOST_CHECK_EQUAL(reqQueue->blocks(), 9);
+    // the repeated requests take no more memory
+    for (size_t i = 0; i < 100; i++)
+    {
+        reqQueue->push(3, 2);
+    }
+    BOOST_CHECK_EQUAL(reqQueue->size(), 2);
+    BOOST_CHECK_EQUAL(reqQueue->blocks(), 9);
+    // bridge the two ranges
+    reqQueue->push(8, 2);
+    BOOST_CHECK_EQUAL(reqQueue->size(), 1);
+    BOOST_CHECK_EQUAL(reqQueue->blocks(), 11);
+    // the range covering the existed ranges
+    reqQueue->push(20, 2);
+    reqQueue->push(25, 2);
+    reqQueue->push(18, 10);
+    BOOST_CHECK_EQUAL(reqQueue->size(), 2);
+    BOOST_CHECK_EQUAL(reqQueue->blocks(), 21);
+
+    checkTopAndPop(reqQueue, 1, 11);
+    checkTopAndPop(reqQueue, 18, 10);
+    BOOST_CHECK(reqQueue->empty());
+    BOOST_CHECK_EQUAL(reqQueue->blocks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(testQueueCapacity)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+    config->setMaxDownloadRequestQueueSize(10);
+    auto reqQueue = std::make_shared<DownloadRequestQueue>(config, config->nodeID());
+
+    reqQueue->push(0, 4);
+    reqQueue->push(6, 4);
+    // only the blocks not queued are counted, and the blocks beyond the capacity are dropped
+    reqQueue->push(2, 20);
+    BOOST_CHECK_EQUAL(reqQueue->blocks(), 10);
+    BOOST_CHECK_EQUAL(reqQueue->size(), 1);
+    reqQueue->push(30, 1);
+    BOOST_CHECK_EQUAL(reqQueue->blocks(), 10);
+    checkTopAndPop(reqQueue, 0, 10);
+    BOOST_CHECK(reqQueue->empty());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
@@ -0,0 +1,77 @@
+/**
+ *  Copyright (C) 2021 bcos-sync.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the EncodedBlockCache
+ * @file EncodedBlockCacheTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-19
+ */
+#include "bcos-sync/state/EncodedBlockCache.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(EncodedBlockCacheTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(testEncodedBlockCache)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto hash1 = hashImpl->hash(bytes{1});
+    auto hash2 = hashImpl->hash(bytes{2});
+    auto blockData = std::make_shared<bytes>(100, 1);
+
+    // at most cache 3 blocks
+    EncodedBlockCache cache(300);
+    for (int64_t i = 1; i <= 4; i++)
+    {
+        cache.insert(i, hash1, blockData);
+    }
+    // the oldest block is evicted
+    BOOST_CHECK(cache.blocks() == 3);
+    BOOST_CHECK(cache.size() == 300);
+    BOOST_CHECK(cache.get(1) == nullptr);
+    BOOST_CHECK(*cache.get(4) == *blockData);
+    BOOST_CHECK(cache.hits() == 1);
+    BOOST_CHECK(cache.misses() == 1);
+    // no space for the older block
+    cache.insert(1, hash1, blockData);
+    BOOST_CHECK(cache.get(1) == nullptr);
+
+    // the block with the same number but different hash drops the newer blocks
+    cache.insert(3, hash2, blockData);
+    BOOST_CHECK(cache.blocks() == 2);
+    BOOST_CHECK(cache.get(4) == nullptr);
+
+    // the committed block mismatches the cached one
+    cache.onNewBlock(3, hash1);
+    BOOST_CHECK(cache.blocks() == 1);
+    BOOST_CHECK(cache.get(2) != nullptr);
+    cache.onNewBlock(2, hash1);
+    BOOST_CHECK(cache.blocks() == 1);
+
+    cache.clear();
+    BOOST_CHECK(cache.size() == 0);
+}
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
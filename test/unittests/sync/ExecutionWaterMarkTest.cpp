@@ -0,0 +1,82 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the ExecutionWaterMark
+ * @file ExecutionWaterMarkTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-15
+ */
+#include "SyncFixture.h"
+#include "bcos-sync/state/ExecutionWaterMark.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <bcos-framework/testutils/crypto/SignatureImpl.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(ExecutionWaterMarkTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(testExecutionWaterMark)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+    config->setExecutionWaterMarkRange(2, 128);
+
+    // not updated until both the execution and the commit are measured
+    auto waterMark = std::make_shared<ExecutionWaterMark>(config);
+    auto initialWaterMark = waterMark->waterMark();
+    waterMark->onBlockExecuted(500);
+    BOOST_CHECK(waterMark->waterMark() == initialWaterMark);
+    // the commit faster than a microsecond is a valid sample
+    waterMark->onBlockCommitted(0);
+    BOOST_CHECK(waterMark->waterMark() == 2);
+
+    // execute 1ms, commit 4ms: 4 blocks executed while committing one, and one more
+    waterMark = std::make_shared<ExecutionWaterMark>(config);
+    waterMark->onBlockExecuted(1000);
+    waterMark->onBlockCommitted(4000);
+    BOOST_CHECK(waterMark->waterMark() == 5);
+    // the time waiting for the transactions stored delays the commit
+    waterMark->onTransactionsStored(2000);
+    waterMark->onBlockCommitted(4000);
+    BOOST_CHECK(waterMark->waterMark() == 7);
+
+    // limited by the memory budget
+    config->setExecutionMemoryBudget(3 * 1024);
+    waterMark->onBlockDecoded(1024);
+    waterMark->onBlockExecuted(1000);
+    BOOST_CHECK(waterMark->waterMark() == 3);
+    config->setExecutionMemoryBudget(0);
+
+    // limited by the max water mark
+    waterMark = std::make_shared<ExecutionWaterMark>(config);
+    waterMark->onBlockExecuted(1);
+    waterMark->onBlockCommitted(1000000);
+    BOOST_CHECK(waterMark->waterMark() == 128);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
@@ -0,0 +1,127 @@
+/**
+ *  Copyright (C) 2021 bcos-sync.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the HeaderChain
+ * @file HeaderChainTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-21
+ */
+#include "bcos-sync/state/HeaderChain.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <bcos-framework/testutils/crypto/SignatureImpl.h>
+#include <bcos-framework/testutils/faker/FakeBlock.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+using namespace bcos::protocol;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(HeaderChainTest, TestPromptFixture)
+
+// the headers (_parentNumber, _parentNumber + _size] linked to the parent
+inline std::vector<BlockHeader::Ptr> fakeHeaders(BlockFactory::Ptr _blockFactory,
+    BlockNumber _parentNumber, HashType const& _parentHash, size_t _size, int64_t _timestamp = 0)
+{
+    std::vector<BlockHeader::Ptr> headers;
+    auto parentHash = _parentHash;
+    for (size_t i = 0; i < _size; i++)
+    {
+        auto blockHeader = _blockFactory->blockHeaderFactory()->createBlockHeader();
+        auto number = _parentNumber + (BlockNumber)i + 1;
+        blockHeader->setNumber(number);
+        blockHeader->setTimestamp(_timestamp);
+        ParentInfoList parentInfo;
+        parentInfo.emplace_back(ParentInfo{number - 1, parentHash});
+        blockHeader->setParentInfo(parentInfo);
+        parentHash = blockHeader->hash();
+        headers.emplace_back(blockHeader);
+    }
+    return headers;
+}
+
+BOOST_AUTO_TEST_CASE(testHeaderChain)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto blockFactory = createBlockFactory(cryptoSuite);
+    auto peer1 = signatureImpl->generateKeyPair()->publicKey();
+    auto peer2 = signatureImpl->generateKeyPair()->publicKey();
+
+    HeaderChain headerChain;
+    auto baseHash = hashImpl->hash(std::string("base"));
+    headerChain.reset(10, baseHash);
+    BOOST_CHECK(headerChain.number() == 10);
+
+    auto headers = fakeHeaders(blockFactory, 10, baseHash, 20);
+    // the headers not linked with each other
+    std::vector<BlockHeader::Ptr> unlinkedHeaders{headers[0], headers[2]};
+    BOOST_CHECK(!headerChain.insert(peer1, unlinkedHeaders));
+
+    // the segments received out of order are pending
+    BOOST_CHECK(headerChain.insert(peer1,
+        std::vector<BlockHeader::Ptr>(headers.begin() + 10, headers.begin() + 20)));
+    BOOST_CHECK(headerChain.connect().empty());
+    BOOST_CHECK(headerChain.number() == 10);
+    auto missingRanges = headerChain.missingRanges(11, 40);
+    BOOST_CHECK(missingRanges.size() == 2);
+    BOOST_CHECK(missingRanges[0] == BlockRange(11, 20));
+    BOOST_CHECK(missingRanges[1] == BlockRange(31, 40));
+
+    BOOST_CHECK(headerChain.insert(
+        peer2, std::vector<BlockHeader::Ptr>(headers.begin(), headers.begin() + 10)));
+    BOOST_CHECK(headerChain.connect().empty());
+    BOOST_CHECK(headerChain.number() == 30);
+    BOOST_CHECK(headerChain.size() == 20);
+    BOOST_CHECK(headerChain.header(15)->hash() == headers[4]->hash());
+    BOOST_CHECK(headerChain.header(31) == nullptr);
+
+    // the headers of another chain conflict with the verified headers
+    auto forkHeaders = fakeHeaders(blockFactory, 30, hashImpl->hash(std::string("fork")), 5);
+    BOOST_CHECK(headerChain.insert(peer1, forkHeaders));
+    auto conflictPeers = headerChain.connect();
+    BOOST_CHECK(conflictPeers.size() == 1);
+    BOOST_CHECK(conflictPeers[0]->data() == peer1->data());
+    BOOST_CHECK(headerChain.number() == 30);
+
+    // match the downloaded blocks with the verified headers
+    auto block = blockFactory->createBlock();
+    block->setBlockHeader(headers[5]);
+    BOOST_CHECK(headerChain.matches(block));
+    auto forkBlock = blockFactory->createBlock();
+    forkBlock->setBlockHeader(fakeHeaders(blockFactory, 15, headers[4]->hash(), 1, 100)[0]);
+    BOOST_CHECK(!headerChain.matches(forkBlock));
+    block->setBlockHeader(forkHeaders[0]);
+    BOOST_CHECK(headerChain.matches(block));
+
+    // the committed headers are dropped
+    headerChain.onNewBlock(20, headers[9]->hash());
+    BOOST_CHECK(headerChain.number() == 30);
+    BOOST_CHECK(headerChain.size() == 10);
+    BOOST_CHECK(headerChain.header(20) == nullptr);
+    // the committed block conflicts with the verified headers
+    headerChain.onNewBlock(21, hashImpl->hash(std::string("conflict")));
+    BOOST_CHECK(headerChain.number() == 21);
+    BOOST_CHECK(headerChain.size() == 0);
+}
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
@@ -0,0 +1,83 @@
+/**
+ *  Copyright (C) 2021 bcos-sync.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for the PeerScore
+ * @file PeerScoreTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-18
+ */
+#include "bcos-sync/state/PeerScore.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(PeerScoreTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(testPeerScore)
+{
+    auto fastPeer = std::make_shared<PeerScore>();
+    auto slowPeer = std::make_shared<PeerScore>();
+    BOOST_CHECK(!fastPeer->measured());
+    BOOST_CHECK(fastPeer->score() == 0);
+
+    // 10KB in 10ms
+    fastPeer->onResponse(10, 10000, 1);
+    BOOST_CHECK(fastPeer->measured());
+    BOOST_CHECK(fastPeer->latency() == 10);
+    BOOST_CHECK(fastPeer->throughput() == 1000000);
+    BOOST_CHECK(fastPeer->blockSize() == 10000);
+    // 10KB in 1000ms
+    slowPeer->onResponse(1000, 10000, 1);
+    BOOST_CHECK(fastPeer->score() > slowPeer->score());
+
+    // the timeout decreases the score and makes the peer backoff
+    auto score = fastPeer->score();
+    fastPeer->onTimeout(1000);
+    BOOST_CHECK(fastPeer->failureRate() > 0);
+    BOOST_CHECK(fastPeer->score() < score);
+    BOOST_CHECK(fastPeer->backoff());
+
+    // the response resets the backoff
+    fastPeer->onResponse(10, 10000, 1);
+    BOOST_CHECK(!fastPeer->backoff());
+    BOOST_CHECK(fastPeer->backoffDeadline() == 0);
+
+    // the timeouts of the new peer do not measure its throughput
+    auto newPeer = std::make_shared<PeerScore>();
+    newPeer->onTimeout(1000);
+    BOOST_CHECK(!newPeer->measured());
+    BOOST_CHECK(newPeer->failureRate() > 0);
+    newPeer->onResponse(10, 10000, 1);
+    BOOST_CHECK(newPeer->measured());
+    BOOST_CHECK(newPeer->throughput() == 1000000);
+    BOOST_CHECK(newPeer->score() > 0);
+
+    // the backoff doubles on the continuous timeouts but is capped at 10s
+    for (size_t i = 0; i < 10; i++)
+    {
+        fastPeer->onTimeout(5000);
+    }
+    BOOST_CHECK(fastPeer->backoff());
+    BOOST_CHECK(fastPeer->backoffDeadline() <= utcTime() + 10000);
+}
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
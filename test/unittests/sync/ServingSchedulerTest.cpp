@@ -0,0 +1,170 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for ServingScheduler
+ * @file ServingSchedulerTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-21
+ */
+#include "SyncFixture.h"
+#include "bcos-sync/state/ServingScheduler.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <bcos-framework/testutils/crypto/SignatureImpl.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(ServingSchedulerTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(testTokenBucket)
+{
+    auto bucket = std::make_shared<TokenBucket>(100);
+    auto now = utcTime();
+    // start full with the tokens of a second
+    BOOST_CHECK(bucket->available(now) == 100);
+    bucket->consume(150);
+    BOOST_CHECK(bucket->available(now) == 0);
+    // the debt is repaid after 500ms
+    BOOST_CHECK(bucket->available(now + 500) == 0);
+    BOOST_CHECK(bucket->available(now + 1000) == 50);
+    // at most the tokens of a second are kept
+    BOOST_CHECK(bucket->available(now + 10000) == 100);
+    bucket->refund(10);
+    BOOST_CHECK(bucket->available(now + 10000) == 100);
+
+    // unlimited
+    bucket->setRate(0);
+    BOOST_CHECK(bucket->unlimited());
+    bucket->consume(1000);
+    BOOST_CHECK(bucket->available() > 1000);
+}
+
+BOOST_AUTO_TEST_CASE(testServingScheduler)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+    config->setMaxServingReadsPerSecond(20);
+    config->setMaxServingBytesPerSecond(1000);
+    config->setMaxServingReadsPerPeer(8);
+
+    auto scheduler = std::make_shared<ServingScheduler>(config);
+    auto greedyPeer = std::make_shared<TokenBucket>(config->maxServingReadsPerPeer());
+    auto otherPeer = std::make_shared<TokenBucket>(config->maxServingReadsPerPeer());
+    // limited by the quota of the peer
+    BOOST_CHECK(scheduler->acquire(greedyPeer, 100) == 8);
+    BOOST_CHECK(scheduler->acquire(greedyPeer, 100) == 0);
+    // the other peer is not starved
+    BOOST_CHECK(scheduler->acquire(otherPeer, 4) == 4);
+    // limited by the global reads budget
+    auto thirdPeer = std::make_shared<TokenBucket>(config->maxServingReadsPerPeer());
+    auto fourthPeer = std::make_shared<TokenBucket>(config->maxServingReadsPerPeer());
+    BOOST_CHECK(scheduler->acquire(thirdPeer, 8) == 8);
+    BOOST_CHECK(scheduler->acquire(fourthPeer, 8) == 0);
+    BOOST_CHECK(scheduler->exhausted());
+    // the cached block returns the read
+    scheduler->onCacheHit();
+    BOOST_CHECK(scheduler->acquire(fourthPeer, 8) == 1);
+
+    // the served bytes overdraw the bytes budget
+    scheduler->updateBudget(1);
+    scheduler->readsBudget()->refund(20);
+    BOOST_CHECK(!scheduler->exhausted());
+    scheduler->onBlockServed(2000);
+    BOOST_CHECK(scheduler->exhausted());
+
+    // the budget shrinks while the node is busy
+    scheduler->updateBudget(config->busyServingRatio());
+    BOOST_CHECK(scheduler->readsBudget()->rate() == 20 * config->busyServingRatio());
+    BOOST_CHECK(scheduler->bytesBudget()->rate() == 1000 * config->busyServingRatio());
+}
+
+BOOST_AUTO_TEST_CASE(testInFlightReads)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+    config->setMaxServingReadsPerSecond(0);
+    config->setMaxServingBytesPerSecond(0);
+    config->setMaxServingReadsPerPeer(0);
+    config->setMaxServingInFlightReads(8);
+
+    auto scheduler = std::make_shared<ServingScheduler>(config);
+    auto peerQuota = std::make_shared<TokenBucket>(0);
+    BOOST_CHECK(scheduler->acquire(peerQuota, 6) == 6);
+    BOOST_CHECK(scheduler->acquire(peerQuota, 6) == 2);
+    BOOST_CHECK(scheduler->inFlightReads() == 8);
+    BOOST_CHECK(scheduler->exhausted());
+    BOOST_CHECK(scheduler->acquire(peerQuota, 6) == 0);
+    // the serving is resumed once half of the reads finished
+    scheduler->onCacheHit();
+    BOOST_CHECK(!scheduler->onReadFinished());
+    BOOST_CHECK(!scheduler->onReadFinished());
+    BOOST_CHECK(scheduler->onReadFinished());
+    BOOST_CHECK(!scheduler->onReadFinished());
+    BOOST_CHECK(scheduler->inFlightReads() == 3);
+    BOOST_CHECK(!scheduler->exhausted());
+}
+
+BOOST_AUTO_TEST_CASE(testFailedReads)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+    auto scheduler = std::make_shared<ServingScheduler>(config);
+    auto reqQueue = std::make_shared<DownloadRequestQueue>(config, config->nodeID());
+
+    // the failed read is requested again after backoff
+    auto now = utcTime();
+    scheduler->onReadFailed(reqQueue, 10);
+    BOOST_CHECK(scheduler->readErrors() == 1);
+    BOOST_CHECK(scheduler->retryingReads() == 1);
+    scheduler->retryFailedReads(now);
+    BOOST_CHECK(reqQueue->empty());
+    scheduler->retryFailedReads(now + 100000);
+    BOOST_CHECK(reqQueue->size() == 1);
+    auto request = reqQueue->topAndPop();
+    BOOST_CHECK(request->fromNumber() == 10);
+    BOOST_CHECK(request->size() == 1);
+
+    // the succeeded read is not retried any more
+    scheduler->onReadSucceeded(reqQueue, 10);
+    BOOST_CHECK(scheduler->retryingReads() == 0);
+
+    // dropped after too many failures
+    for (size_t i = 0; i < 7; i++)
+    {
+        scheduler->onReadFailed(reqQueue, 11);
+    }
+    BOOST_CHECK(scheduler->retryingReads() == 0);
+    BOOST_CHECK(scheduler->droppedReads() == 1);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos
@@ -56,6 +56,21 @@ void testSyncConfig(CryptoSuite::Ptr _cryptoSuite)
     BOOST_CHECK(config->blockNumber() == faker->ledger()->blockNumber());
     BOOST_CHECK(config->nextBlock() == faker->ledger()->blockNumber() + 1);
     BOOST_CHECK(config->hash().asBytes() == faker->ledger()->ledgerConfig()->hash().asBytes());
+    auto chainTip = config->chainTip();
+    BOOST_CHECK(chainTip->number == config->blockNumber());
+    BOOST_CHECK(chainTip->hash == config->hash());
+
+    // the known chain tip is only increased
+    auto hashImpl = _cryptoSuite->hashImpl();
+    auto knownNumber = config->knownHighestNumber();
+    auto knownHash = hashImpl->hash(std::string("known"));
+    BOOST_CHECK(config->updateKnownChainTip(knownNumber + 10, knownHash));
+    BOOST_CHECK(config->knownHighestNumber() == knownNumber + 10);
+    BOOST_CHECK(config->knownChainTip()->number == knownNumber + 10);
+    BOOST_CHECK(config->knownLatestHash() == knownHash);
+    BOOST_CHECK(!config->updateKnownChainTip(knownNumber + 5, hashImpl->hash(std::string("old"))));
+    BOOST_CHECK(config->knownHighestNumber() == knownNumber + 10);
+    BOOST_CHECK(config->knownLatestHash() == knownHash);
 }
 
 BOOST_AUTO_TEST_CASE(testNonSMSyncConfig)
@@ -39,6 +39,16 @@ namespace bcos
 {
 namespace test
 {
+// the block with the header of the given number only
+inline Block::Ptr fakeBlockWithNumber(BlockFactory::Ptr _blockFactory, BlockNumber _number)
+{
+    auto block = _blockFactory->createBlock();
+    auto blockHeader = _blockFactory->blockHeaderFactory()->createBlockHeader();
+    blockHeader->setNumber(_number);
+    block->setBlockHeader(blockHeader);
+    return block;
+}
+
 class FakeBlockSync : public BlockSync
 {
 public:
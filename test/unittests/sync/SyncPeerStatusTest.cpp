@@ -0,0 +1,90 @@
+/**
+ *  Copyright (C) 2021 FISCO BCOS.
+ *  SPDX-License-Identifier: Apache-2.0
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ * @brief test for SyncPeerStatus
+ * @file SyncPeerStatusTest.cpp
+ * @author: yujiechen
+ * @date 2021-06-24
+ */
+#include "SyncFixture.h"
+#include "bcos-sync/state/SyncPeerStatus.h"
+#include <bcos-framework/testutils/TestPromptFixture.h>
+#include <bcos-framework/testutils/crypto/HashImpl.h>
+#include <bcos-framework/testutils/crypto/SignatureImpl.h>
+#include <boost/test/unit_test.hpp>
+
+using namespace bcos;
+using namespace bcos::sync;
+using namespace bcos::crypto;
+
+namespace bcos
+{
+namespace test
+{
+BOOST_FIXTURE_TEST_SUITE(SyncPeerStatusTest, TestPromptFixture)
+
+BOOST_AUTO_TEST_CASE(testPeersSnapshot)
+{
+    auto hashImpl = std::make_shared<Keccak256Hash>();
+    auto signatureImpl = std::make_shared<Secp256k1SignatureImpl>();
+    auto cryptoSuite = std::make_shared<CryptoSuite>(hashImpl, signatureImpl, nullptr);
+    auto faker = std::make_shared<SyncFixture>(cryptoSuite, std::make_shared<FakeGateWay>());
+    auto config = faker->syncConfig();
+    auto syncStatus = std::make_shared<SyncPeerStatus>(config);
+
+    std::vector<PublicPtr> nodeIDs;
+    for (size_t i = 0; i < 4; i++)
+    {
+        auto nodeID = signatureImpl->generateKeyPair()->publicKey();
+        auto status = config->msgFactory()->createBlockSyncStatusMsg(
+            i + 1, hashImpl->hash(std::to_string(i)), config->genesisHash());
+        BOOST_CHECK(syncStatus->updatePeerStatus(nodeID, status));
+        nodeIDs.emplace_back(nodeID);
+    }
+    BOOST_CHECK(syncStatus->peers()->size() == 4);
+    BOOST_CHECK(config->knownHighestNumber() == 4);
+
+    auto nodeID = nodeIDs[0];
+    BOOST_CHECK(syncStatus->hasPeer(nodeID));
+    // the status is updated in place
+    auto peer = syncStatus->peerStatus(nodeID);
+    auto status = config->msgFactory()->createBlockSyncStatusMsg(
+        10, hashImpl->hash(std::string("10")), config->genesisHash());
+    BOOST_CHECK(syncStatus->updatePeerStatus(nodeID, status));
+    BOOST_CHECK(syncStatus->peerStatus(nodeID) == peer);
+    BOOST_CHECK(peer->number() == 10);
+    BOOST_CHECK(config->knownHighestNumber() == 10);
+
+    // the snapshot is stable while the peers are deleted
+    size_t accessedPeers = 0;
+    syncStatus->foreachPeer([&](PeerStatus::Ptr _peer) {
+        syncStatus->deletePeer(_peer->nodeId());
+        accessedPeers++;
+        return true;
+    });
+    BOOST_CHECK(accessedPeers == 4);
+    BOOST_CHECK(syncStatus->peers()->empty());
+    BOOST_CHECK(!syncStatus->hasPeer(nodeID));
+
+    // the status with different genesis hash is rejected
+    auto invalidStatus = config->msgFactory()->createBlockSyncStatusMsg(
+        1, hashImpl->hash(std::string("1")), hashImpl->hash(std::string("genesis")));
+    BOOST_CHECK(!syncStatus->updatePeerStatus(nodeID, invalidStatus));
+    BOOST_CHECK(!syncStatus->hasPeer(nodeID));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+}  // namespace test
+}  // namespace bcos